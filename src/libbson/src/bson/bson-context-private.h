@@ -44,6 +44,9 @@ struct _bson_context_t {
    uint64_t seq64;
    uint8_t randomness[BSON_OID_RANDOMNESS_SIZE];
    uint64_t pid;
+   /* For the default context: the fork generation when randomness was last
+    * initialized. See _bson_context_set_oid_rand. Atomic. */
+   int fork_generation;
 };
 
 /**
@@ -65,6 +68,30 @@ _bson_context_set_oid_rand (bson_context_t *context, bson_oid_t *oid);
 void
 _bson_context_set_oid_seq32 (bson_context_t *context, bson_oid_t *oid);
 
+/**
+ * @brief Reserve @p n consecutive values of the context's 32-bit sequence
+ * counter, returning the first.
+ *
+ * @param context The context with the counter to update
+ * @param n The number of values to reserve
+ * @param timestamp The time the values will be written into OIDs with
+ *
+ * @note For the default context, values are handed out from a block reserved
+ * by the calling thread, so threads do not contend on the shared counter.
+ */
+uint32_t
+_bson_context_reserve_oid_seq32 (bson_context_t *context, uint32_t n, uint32_t timestamp);
+
+/**
+ * @brief Write the given 32-bit sequence value into the OID.
+ *
+ * @param seq The sequence value, as returned by
+ * @ref _bson_context_reserve_oid_seq32
+ * @param oid The OID to modify
+ */
+void
+_bson_context_write_oid_seq32 (uint32_t seq, bson_oid_t *oid);
+
 /**
  * @brief Write a 64-bit counter from the given context into the OID. Increments
  * the context's sequence counter.
@@ -27,6 +27,7 @@
 #include <bson/bson-context.h>
 #include <bson/bson-context-private.h>
 #include <bson/bson-memory.h>
+#include <bson/bson-oid.h>
 #include "common-thread-private.h"
 
 
@@ -35,11 +36,39 @@
 #endif
 
 
+/* Number of sequence values each thread reserves at once from the default
+ * context's counter. */
+#define BSON_CONTEXT_SEQ32_BLOCK_SIZE 64u
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BSON_CONTEXT_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define BSON_CONTEXT_THREAD_LOCAL __declspec (thread)
+#endif
+
+
 /*
  * Globals.
  */
 static bson_context_t gContextDefault;
 
+#ifdef BSON_CONTEXT_THREAD_LOCAL
+/* The calling thread's unused sequence values from the default context, and
+ * the OID timestamp they were reserved for. */
+static BSON_CONTEXT_THREAD_LOCAL uint32_t gSeq32BlockNext;
+static BSON_CONTEXT_THREAD_LOCAL uint32_t gSeq32BlockRemaining;
+static BSON_CONTEXT_THREAD_LOCAL uint32_t gSeq32BlockTime;
+#endif
+
+#ifndef BSON_OS_WIN32
+/* Incremented in the child after fork(). Lets the default context detect a
+ * fork without calling getpid() for every ObjectID. */
+static int gForkGeneration;
+/* Whether the fork handler was installed. If not, the default context falls
+ * back to calling getpid() for every ObjectID. */
+static bool gForkHandlerInstalled;
+#endif
+
 static BSON_INLINE uint64_t
 _bson_getpid (void)
 {
@@ -57,17 +86,65 @@ _bson_getpid (void)
 }
 
 
+uint32_t
+_bson_context_reserve_oid_seq32 (bson_context_t *context, /* IN */
+                                 uint32_t n,              /* IN */
+                                 uint32_t timestamp)      /* IN */
+{
+   uint32_t seq;
+
+   BSON_ASSERT (n > 0u);
+
+   /* Only uniqueness of the values matters, not their order relative to
+    * other memory operations, so relaxed ordering suffices. */
+#ifdef BSON_CONTEXT_THREAD_LOCAL
+   if (context == &gContextDefault && n <= BSON_CONTEXT_SEQ32_BLOCK_SIZE) {
+      /* A block is only used within the second it was reserved in. Once the
+       * shared counter wraps, a later second may hand the same values to
+       * another thread. */
+      if (gSeq32BlockRemaining < n || gSeq32BlockTime != timestamp) {
+         gSeq32BlockNext = (uint32_t) bson_atomic_int32_fetch_add ((DECL_ATOMIC_INTEGRAL_INT32 *) &context->seq32,
+                                                                   (int32_t) BSON_CONTEXT_SEQ32_BLOCK_SIZE,
+                                                                   bson_memory_order_relaxed);
+         gSeq32BlockRemaining = BSON_CONTEXT_SEQ32_BLOCK_SIZE;
+         gSeq32BlockTime = timestamp;
+      }
+
+      seq = gSeq32BlockNext;
+      gSeq32BlockNext += n;
+      gSeq32BlockRemaining -= n;
+
+      return seq;
+   }
+#endif
+
+   BSON_UNUSED (timestamp);
+   BSON_ASSERT (n <= (uint32_t) INT32_MAX);
+
+   return (uint32_t) bson_atomic_int32_fetch_add (
+      (DECL_ATOMIC_INTEGRAL_INT32 *) &context->seq32, (int32_t) n, bson_memory_order_relaxed);
+}
+
+
 void
-_bson_context_set_oid_seq32 (bson_context_t *context, /* IN */
-                             bson_oid_t *oid)         /* OUT */
+_bson_context_write_oid_seq32 (uint32_t seq,    /* IN */
+                               bson_oid_t *oid) /* OUT */
 {
-   uint32_t seq = (uint32_t) bson_atomic_int32_fetch_add (
-      (DECL_ATOMIC_INTEGRAL_INT32 *) &context->seq32, 1, bson_memory_order_seq_cst);
    seq = BSON_UINT32_TO_BE (seq);
    memcpy (&oid->bytes[BSON_OID_SEQ32_OFFSET], ((uint8_t *) &seq) + 1, BSON_OID_SEQ32_SIZE);
 }
 
 
+void
+_bson_context_set_oid_seq32 (bson_context_t *context, /* IN */
+                             bson_oid_t *oid)         /* OUT */
+{
+   const uint32_t timestamp = (uint32_t) bson_oid_get_time_t (oid);
+
+   _bson_context_write_oid_seq32 (_bson_context_reserve_oid_seq32 (context, 1u, timestamp), oid);
+}
+
+
 void
 _bson_context_set_oid_seq64 (bson_context_t *context, /* IN */
                              bson_oid_t *oid)         /* OUT */
@@ -302,6 +379,11 @@ _bson_context_init_random (bson_context_t *context, bool init_seq)
 
    /* Remember the PID we saw here. This may change in case of fork() */
    context->pid = rand_params.pid;
+#ifndef BSON_OS_WIN32
+   bson_atomic_int_exchange (&context->fork_generation,
+                             bson_atomic_int_fetch (&gForkGeneration, bson_memory_order_relaxed),
+                             bson_memory_order_relaxed);
+#endif
 }
 
 static void
@@ -319,11 +401,28 @@ _bson_context_set_oid_rand (bson_context_t *context, bson_oid_t *oid)
    BSON_ASSERT (oid);
 
    if (context->flags & BSON_CONTEXT_DISABLE_PID_CACHE) {
+#ifndef BSON_OS_WIN32
+      /* The default context only needs to check the PID after a fork. */
+      const bool may_have_forked =
+         context != &gContextDefault || !gForkHandlerInstalled ||
+         bson_atomic_int_fetch (&gForkGeneration, bson_memory_order_relaxed) !=
+            bson_atomic_int_fetch (&context->fork_generation, bson_memory_order_relaxed);
+#else
+      const bool may_have_forked = true;
+#endif
+
       /* User has requested that we check if our PID has changed. This can occur
        * after a call to fork() */
-      uint64_t now_pid = _bson_getpid ();
-      if (now_pid != context->pid) {
-         _bson_context_init_random (context, false /* Do not update the sequence counters */);
+      if (may_have_forked) {
+         uint64_t now_pid = _bson_getpid ();
+         if (now_pid != context->pid) {
+            _bson_context_init_random (context, false /* Do not update the sequence counters */);
+         }
+#ifndef BSON_OS_WIN32
+         bson_atomic_int_exchange (&context->fork_generation,
+                                   bson_atomic_int_fetch (&gForkGeneration, bson_memory_order_relaxed),
+                                   bson_memory_order_relaxed);
+#endif
       }
    }
    /* Copy the stored randomness into the OID */
@@ -350,8 +449,20 @@ bson_context_destroy (bson_context_t *context) /* IN */
 }
 
 
+#ifndef BSON_OS_WIN32
+static void
+_bson_context_atfork_child (void)
+{
+   bson_atomic_int_fetch_add (&gForkGeneration, 1, bson_memory_order_relaxed);
+}
+#endif
+
+
 static BSON_ONCE_FUN (_bson_context_init_default)
 {
+#ifndef BSON_OS_WIN32
+   gForkHandlerInstalled = pthread_atfork (NULL, NULL, _bson_context_atfork_child) == 0;
+#endif
    _bson_context_init (&gContextDefault, BSON_CONTEXT_DISABLE_PID_CACHE);
    BSON_ONCE_RETURN;
 }
@@ -114,6 +114,50 @@ bson_oid_init (bson_oid_t *oid,         /* OUT */
 }
 
 
+void
+bson_oid_init_n (bson_oid_t *oids,        /* OUT */
+                 size_t n_oids,           /* IN */
+                 bson_context_t *context) /* IN */
+{
+   /* Larger groups would wrap the 24-bit counter within a single second. */
+   const uint32_t max_per_group = UINT32_C (1) << 24;
+   const bson_oid_t *first;
+   uint32_t n;
+   uint32_t seq;
+   size_t i;
+   size_t j;
+
+   BSON_ASSERT_PARAM (oids);
+
+   if (n_oids == 0u) {
+      return;
+   }
+
+   if (!context) {
+      context = bson_context_get_default ();
+   }
+
+   for (i = 0u; i < n_oids; i += n) {
+      n = (uint32_t) BSON_MIN (n_oids - i, (size_t) max_per_group);
+
+      /* Each group reads the time and randomness once, as bson_oid_init would
+       * for its first OID, and the rest of the group only differs in the
+       * counter. */
+      first = &oids[i];
+      _oid_init (&oids[i], context, true /* add randomness */);
+      if (n == 1u) {
+         continue;
+      }
+
+      seq = _bson_context_reserve_oid_seq32 (context, n - 1u, (uint32_t) bson_oid_get_time_t (first));
+      for (j = i + 1u; j < i + n; j++, seq++) {
+         memcpy (oids[j].bytes, first->bytes, BSON_OID_SEQ32_OFFSET);
+         _bson_context_write_oid_seq32 (seq, &oids[j]);
+      }
+   }
+}
+
+
 void
 bson_oid_init_from_data (bson_oid_t *oid,     /* OUT */
                          const uint8_t *data) /* IN */
@@ -47,6 +47,8 @@ bson_oid_hash (const bson_oid_t *oid);
 BSON_EXPORT (void)
 bson_oid_init (bson_oid_t *oid, bson_context_t *context);
 BSON_EXPORT (void)
+bson_oid_init_n (bson_oid_t *oids, size_t n_oids, bson_context_t *context);
+BSON_EXPORT (void)
 bson_oid_init_from_data (bson_oid_t *oid, const uint8_t *data);
 BSON_EXPORT (void)
 bson_oid_init_from_string (bson_oid_t *oid, const char *str);
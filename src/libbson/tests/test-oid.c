@@ -327,6 +327,104 @@ test_bson_oid_init_with_threads (void)
 }
 
 
+#define N_OIDS_PER_THREAD 20000
+
+BSON_THREAD_FUN (oid_default_context_worker, data)
+{
+   bson_oid_t *oids = data;
+   int i;
+
+   for (i = 0; i < N_OIDS_PER_THREAD; i++) {
+      bson_oid_init (&oids[i], NULL);
+   }
+
+   BSON_THREAD_RETURN;
+}
+
+
+static int
+_oid_qsort_compare (const void *a, const void *b)
+{
+   return bson_oid_compare ((const bson_oid_t *) a, (const bson_oid_t *) b);
+}
+
+
+static void
+test_bson_oid_init_with_threads_default_context (void)
+{
+   bson_thread_t threads[N_THREADS];
+   bson_oid_t *oids;
+   size_t i;
+   int r;
+
+   /* Threads reserve blocks of the default context's counter; OIDs must still
+    * be unique across threads. */
+   oids = bson_malloc (N_THREADS * N_OIDS_PER_THREAD * sizeof (bson_oid_t));
+
+   for (i = 0; i < N_THREADS; i++) {
+      r = mcommon_thread_create (&threads[i], oid_default_context_worker, oids + i * N_OIDS_PER_THREAD);
+      BSON_ASSERT (r == 0);
+   }
+
+   for (i = 0; i < N_THREADS; i++) {
+      r = mcommon_thread_join (threads[i]);
+      BSON_ASSERT (r == 0);
+   }
+
+   qsort (oids, N_THREADS * N_OIDS_PER_THREAD, sizeof (bson_oid_t), _oid_qsort_compare);
+
+   for (i = 1; i < N_THREADS * N_OIDS_PER_THREAD; i++) {
+      BSON_ASSERT (!bson_oid_equal (&oids[i - 1], &oids[i]));
+   }
+
+   bson_free (oids);
+}
+
+
+static void
+test_bson_oid_init_n (void)
+{
+   bson_context_t *context;
+   bson_oid_t oids[200];
+   bson_oid_t oid;
+   size_t i;
+
+   context = bson_context_new (BSON_CONTEXT_NONE);
+   context->seq32 = 0;
+
+   bson_oid_init_n (oids, 100, context);
+
+   for (i = 0; i < 100; i++) {
+      /* the timestamp and random bytes are shared, the counter increments. */
+      BSON_ASSERT (0 == memcmp (oids[i].bytes, oids[0].bytes, 9));
+      ASSERT_CMPUINT32 ((uint32_t) ((oids[i].bytes[9] << 16) | (oids[i].bytes[10] << 8) | oids[i].bytes[11]),
+                        ==,
+                        (uint32_t) i);
+   }
+
+   /* the context's counter continues after the batch. */
+   bson_oid_init (&oid, context);
+   BSON_ASSERT (0 < bson_oid_compare (&oid, &oids[99]));
+   ASSERT_CMPUINT32 ((uint32_t) oid.bytes[11], ==, 100u);
+
+   /* no OIDs are written for an empty batch. */
+   memset (&oid, 0, sizeof oid);
+   bson_oid_init_n (&oid, 0, context);
+   for (i = 0; i < sizeof oid.bytes; i++) {
+      ASSERT_CMPUINT32 ((uint32_t) oid.bytes[i], ==, 0u);
+   }
+
+   bson_context_destroy (context);
+
+   /* the default context, with a batch larger than a thread's reserved block. */
+   bson_oid_init_n (oids, 200, NULL);
+   qsort (oids, 200, sizeof (bson_oid_t), _oid_qsort_compare);
+   for (i = 1; i < 200; i++) {
+      BSON_ASSERT (!bson_oid_equal (&oids[i - 1], &oids[i]));
+   }
+}
+
+
 static void
 test_bson_oid_counter_overflow (void)
 {
@@ -475,6 +573,9 @@ test_oid_install (TestSuite *suite)
    TestSuite_Add (suite, "/bson/oid/init_from_string", test_bson_oid_init_from_string);
    TestSuite_Add (suite, "/bson/oid/init_sequence", test_bson_oid_init_sequence);
    TestSuite_Add (suite, "/bson/oid/init_with_threads", test_bson_oid_init_with_threads);
+   TestSuite_Add (
+      suite, "/bson/oid/init_with_threads/default_context", test_bson_oid_init_with_threads_default_context);
+   TestSuite_Add (suite, "/bson/oid/init_n", test_bson_oid_init_n);
    TestSuite_Add (suite, "/bson/oid/hash", test_bson_oid_hash);
    TestSuite_Add (suite, "/bson/oid/compare", test_bson_oid_compare);
    TestSuite_Add (suite, "/bson/oid/copy", test_bson_oid_copy);
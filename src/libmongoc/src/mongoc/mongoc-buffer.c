@@ -211,6 +211,67 @@ _mongoc_buffer_append_from_stream (
 }
 
 
+/**
+ * _mongoc_buffer_append_at_least_from_stream:
+ * @buffer; A mongoc_buffer_t.
+ * @stream: The stream to read from.
+ * @min_bytes: The minimum number of bytes to read.
+ * @timeout_msec: The number of milliseconds to wait or -1 for the default
+ * @error: A location for a bson_error_t, or NULL.
+ *
+ * Like _mongoc_buffer_append_from_stream, but also appends whatever else is
+ * already available from @stream, up to the buffer's free capacity. Only use
+ * this when @stream cannot have data beyond what the caller will consume.
+ *
+ * Returns: true if successful; otherwise false and @error is set.
+ */
+bool
+_mongoc_buffer_append_at_least_from_stream (
+   mongoc_buffer_t *buffer, mongoc_stream_t *stream, size_t min_bytes, int64_t timeout_msec, bson_error_t *error)
+{
+   uint8_t *buf;
+   ssize_t ret;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM (buffer);
+   BSON_ASSERT_PARAM (stream);
+   BSON_ASSERT (min_bytes);
+
+   BSON_ASSERT (buffer->datalen);
+
+   make_space_for (buffer, min_bytes);
+
+   buf = &buffer->data[buffer->len];
+
+   BSON_ASSERT ((buffer->len + min_bytes) <= buffer->datalen);
+
+   if (BSON_UNLIKELY (!bson_in_range_signed (int32_t, timeout_msec))) {
+      // CDRIVER-4589
+      bson_set_error (error,
+                      MONGOC_ERROR_STREAM,
+                      MONGOC_ERROR_STREAM_SOCKET,
+                      "timeout_msec value %" PRId64 " exceeds supported 32-bit range",
+                      timeout_msec);
+      RETURN (false);
+   }
+
+   ret = mongoc_stream_read (stream, buf, buffer->datalen - buffer->len, min_bytes, (int32_t) timeout_msec);
+   if (ret < 0 || bson_cmp_less_su (ret, min_bytes)) {
+      bson_set_error (error,
+                      MONGOC_ERROR_STREAM,
+                      MONGOC_ERROR_STREAM_SOCKET,
+                      "Failed to read %zu bytes: socket error or timeout",
+                      min_bytes);
+      RETURN (false);
+   }
+
+   buffer->len += (size_t) ret;
+
+   RETURN (true);
+}
+
+
 /**
  * _mongoc_buffer_fill:
  * @buffer: A mongoc_buffer_t.
@@ -40,6 +40,10 @@ struct _mongoc_bulk_operation_t {
    mongoc_write_result_t result;
    bool executed;
    int64_t operation_id;
+   /* if true, queued commands are sent as soon as they fill a batch */
+   bool streaming;
+   /* number of operations already sent by streaming flushes */
+   uint32_t n_flushed;
 };
 
 
@@ -136,6 +136,125 @@ mongoc_bulk_operation_destroy (mongoc_bulk_operation_t *bulk) /* IN */
    } while (0)
 
 
+/* true if a failure means no further operations of this bulk may be sent */
+static bool
+_mongoc_bulk_operation_stopped (const mongoc_bulk_operation_t *bulk)
+{
+   return bulk->result.error.domain || (bulk->result.failed && (bulk->flags.ordered || bulk->result.must_stop));
+}
+
+
+/* Send the queued commands in order, merging their replies into
+ * bulk->result. Returns false if no server could be selected, in which case
+ * stream_for_server or stream_for_writes has initialized reply and error. */
+static bool
+_mongoc_bulk_operation_send_commands (mongoc_bulk_operation_t *bulk, bson_t *reply, bson_error_t *error)
+{
+   mongoc_cluster_t *cluster = &bulk->client->cluster;
+   mongoc_write_command_t *command;
+   mongoc_server_stream_t *server_stream;
+   uint32_t offset = bulk->n_flushed;
+
+   for (size_t i = 0u; i < bulk->commands.len; i++) {
+      if (bulk->server_id) {
+         server_stream = mongoc_cluster_stream_for_server (
+            cluster, bulk->server_id, true /* reconnect_ok */, bulk->session, reply, error);
+      } else {
+         server_stream = mongoc_cluster_stream_for_writes (cluster, bulk->session, NULL, reply, error);
+      }
+
+      if (!server_stream) {
+         return false;
+      }
+
+      command = &_mongoc_array_index (&bulk->commands, mongoc_write_command_t, i);
+
+      _mongoc_write_command_execute (command,
+                                     bulk->client,
+                                     server_stream,
+                                     bulk->database,
+                                     bulk->collection,
+                                     bulk->write_concern,
+                                     offset,
+                                     bulk->session,
+                                     &bulk->result);
+
+      bulk->server_id = server_stream->sd->id;
+      /* If a retryable error occurred and a new primary was selected, use it in
+       * subsequent commands. */
+      if (bulk->result.retry_server_id) {
+         bulk->server_id = bulk->result.retry_server_id;
+      }
+
+      mongoc_server_stream_cleanup (server_stream);
+
+      if (bulk->result.failed && (bulk->flags.ordered || bulk->result.must_stop)) {
+         break;
+      }
+
+      offset += command->n_documents;
+   }
+
+   return true;
+}
+
+
+static void
+_mongoc_bulk_operation_discard_commands (mongoc_bulk_operation_t *bulk)
+{
+   mongoc_write_command_t *command;
+
+   for (size_t i = 0u; i < bulk->commands.len; i++) {
+      command = &_mongoc_array_index (&bulk->commands, mongoc_write_command_t, i);
+      bulk->n_flushed += command->n_documents;
+      _mongoc_write_command_destroy (command);
+   }
+
+   bulk->commands.len = 0u;
+}
+
+
+/* In streaming mode, send the queued commands once they hold a full batch's
+ * worth of operations or bytes, then discard them. Errors are recorded in
+ * bulk->result and reported by mongoc_bulk_operation_execute. */
+static void
+_mongoc_bulk_operation_maybe_flush (mongoc_bulk_operation_t *bulk)
+{
+   mongoc_write_command_t *command;
+   uint32_t n_documents = 0u;
+   size_t n_bytes = 0u;
+
+   if (!bulk->streaming || !bulk->client || !bulk->database || !bulk->collection) {
+      return;
+   }
+
+   /* operations added after the bulk stopped are never sent, so do not let
+    * them accumulate until execute */
+   if (_mongoc_bulk_operation_stopped (bulk)) {
+      _mongoc_bulk_operation_discard_commands (bulk);
+      return;
+   }
+
+   for (size_t i = 0u; i < bulk->commands.len; i++) {
+      command = &_mongoc_array_index (&bulk->commands, mongoc_write_command_t, i);
+      n_documents += command->n_documents;
+      n_bytes += command->payload.len;
+   }
+
+   if (n_documents < (uint32_t) mongoc_cluster_get_max_write_batch_size (&bulk->client->cluster) &&
+       n_bytes < (size_t) mongoc_cluster_get_max_msg_size (&bulk->client->cluster)) {
+      return;
+   }
+
+   if (!_mongoc_bulk_operation_send_commands (bulk, NULL /* reply */, &bulk->result.error)) {
+      bulk->result.failed = true;
+      bulk->result.must_stop = true;
+   }
+
+   _mongoc_bulk_operation_discard_commands (bulk);
+}
+
+
 static bool
 _mongoc_bulk_operation_remove_with_opts (mongoc_bulk_operation_t *bulk,
                                          const bson_t *selector,
@@ -211,6 +330,10 @@ _mongoc_bulk_operation_remove_with_opts (mongoc_bulk_operation_t *bulk,
    ret = true;
 
 done:
+   if (ret) {
+      _mongoc_bulk_operation_maybe_flush (bulk);
+   }
+
    bson_destroy (&cmd_opts);
    bson_destroy (&opts);
    RETURN (ret);
@@ -396,6 +519,10 @@ mongoc_bulk_operation_insert_with_opts (mongoc_bulk_operation_t *bulk,
    ret = true;
 
 done:
+   if (ret) {
+      _mongoc_bulk_operation_maybe_flush (bulk);
+   }
+
    _mongoc_bulk_insert_opts_cleanup (&insert_opts);
    bson_destroy (&cmd_opts);
 
@@ -471,6 +598,8 @@ _mongoc_bulk_operation_update_append (mongoc_bulk_operation_t *bulk,
    _mongoc_array_append_val (&bulk->commands, command);
 
 done:
+   _mongoc_bulk_operation_maybe_flush (bulk);
+
    bson_destroy (&cmd_opts);
    bson_destroy (&opts);
 }
@@ -709,11 +838,7 @@ mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
                                bson_t *reply,                 /* OUT */
                                bson_error_t *error)           /* OUT */
 {
-   mongoc_cluster_t *cluster;
-   mongoc_write_command_t *command;
-   mongoc_server_stream_t *server_stream;
    bool ret;
-   uint32_t offset = 0;
 
    ENTRY;
 
@@ -727,7 +852,6 @@ mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
                       "and one has not been set.");
       GOTO (err);
    }
-   cluster = &bulk->client->cluster;
 
    if (bulk->executed) {
       _mongoc_write_result_destroy (&bulk->result);
@@ -752,6 +876,12 @@ mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
       GOTO (err);
    }
 
+   /* operations already sent in streaming mode are reported along with any
+    * error that stopped the bulk */
+   if (bulk->n_flushed && _mongoc_bulk_operation_stopped (bulk)) {
+      GOTO (cleanup);
+   }
+
    /* error stored by functions like mongoc_bulk_operation_insert that
     * can't report errors immediately */
    if (bulk->result.error.domain) {
@@ -762,50 +892,14 @@ mongoc_bulk_operation_execute (mongoc_bulk_operation_t *bulk, /* IN */
       GOTO (err);
    }
 
-   if (!bulk->commands.len) {
+   if (!bulk->commands.len && !bulk->n_flushed) {
       bson_set_error (error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Cannot do an empty bulk write");
       GOTO (err);
    }
 
-   for (size_t i = 0u; i < bulk->commands.len; i++) {
-      if (bulk->server_id) {
-         server_stream = mongoc_cluster_stream_for_server (
-            cluster, bulk->server_id, true /* reconnect_ok */, bulk->session, reply, error);
-      } else {
-         server_stream = mongoc_cluster_stream_for_writes (cluster, bulk->session, NULL, reply, error);
-      }
-
-      if (!server_stream) {
-         /* stream_for_server and stream_for_writes initialize reply on error */
-         RETURN (false);
-      }
-
-      command = &_mongoc_array_index (&bulk->commands, mongoc_write_command_t, i);
-
-      _mongoc_write_command_execute (command,
-                                     bulk->client,
-                                     server_stream,
-                                     bulk->database,
-                                     bulk->collection,
-                                     bulk->write_concern,
-                                     offset,
-                                     bulk->session,
-                                     &bulk->result);
-
-      bulk->server_id = server_stream->sd->id;
-      /* If a retryable error occurred and a new primary was selected, use it in
-       * subsequent commands. */
-      if (bulk->result.retry_server_id) {
-         bulk->server_id = bulk->result.retry_server_id;
-      }
-
-      if (bulk->result.failed && (bulk->flags.ordered || bulk->result.must_stop)) {
-         mongoc_server_stream_cleanup (server_stream);
-         GOTO (cleanup);
-      }
-
-      offset += command->n_documents;
-      mongoc_server_stream_cleanup (server_stream);
+   if (!_mongoc_bulk_operation_send_commands (bulk, reply, error)) {
+      /* stream_for_server and stream_for_writes initialize reply on error */
+      RETURN (false);
    }
 
 cleanup:
@@ -982,3 +1076,16 @@ mongoc_bulk_operation_set_let (mongoc_bulk_operation_t *bulk, const bson_t *let)
    bson_destroy (&bulk->let);
    bson_copy_to (let, &bulk->let);
 }
+
+
+void
+mongoc_bulk_operation_set_streaming (mongoc_bulk_operation_t *bulk, bool streaming)
+{
+   BSON_ASSERT_PARAM (bulk);
+
+   /* Operations appended before this call would be sent later than the
+    * caller expects, so it may only be called on an empty bulk. */
+   BSON_ASSERT (bulk->commands.len == 0 && bulk->n_flushed == 0);
+
+   bulk->streaming = streaming;
+}
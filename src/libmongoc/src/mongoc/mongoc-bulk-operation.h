@@ -111,6 +111,8 @@ MONGOC_EXPORT (void)
 mongoc_bulk_operation_set_comment (mongoc_bulk_operation_t *bulk, const bson_value_t *comment);
 MONGOC_EXPORT (void)
 mongoc_bulk_operation_set_let (mongoc_bulk_operation_t *bulk, const bson_t *let);
+MONGOC_EXPORT (void)
+mongoc_bulk_operation_set_streaming (mongoc_bulk_operation_t *bulk, bool streaming);
 
 
 /*
@@ -0,0 +1,429 @@
+/*
+ * Copyright 2024-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-change-stream-mux.h"
+#include "mongoc-array-private.h"
+#include "mongoc-error.h"
+#include "mongoc-queue-private.h"
+#include "mongoc-thread-private.h"
+#include "mongoc-util-private.h"
+
+
+struct _mongoc_change_stream_mux_t {
+   /* only used by the thread that is pumping */
+   mongoc_change_stream_t *stream;
+
+   /* protects the fields below and the subscribers */
+   bson_mutex_t mutex;
+   /* signaled when a thread is done pumping */
+   mongoc_cond_t cond;
+   bool pumping;
+   mongoc_array_t subscribers; /* mongoc_change_stream_subscriber_t * */
+   bson_error_t error;
+   bson_t error_doc;
+};
+
+
+struct _mongoc_change_stream_subscriber_t {
+   mongoc_change_stream_mux_t *mux;
+   mongoc_change_stream_filter_cb_t filter; /* NULL to receive every event */
+   void *filter_ctx;
+   uint32_t max_queued;  /* 0 for no limit */
+   mongoc_queue_t queue; /* bson_t * */
+   bson_t *current;
+   bson_t resume_token;
+   bson_error_t error;
+};
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_change_stream_mux_new --
+ *
+ *       Create a mongoc_change_stream_mux_t that dispatches the events of
+ *       @stream to its subscribers. @stream is owned by the mux and freed
+ *       by mongoc_change_stream_mux_destroy.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_change_stream_mux_t *
+mongoc_change_stream_mux_new (mongoc_change_stream_t *stream)
+{
+   mongoc_change_stream_mux_t *mux;
+
+   BSON_ASSERT_PARAM (stream);
+
+   mux = BSON_ALIGNED_ALLOC0 (mongoc_change_stream_mux_t);
+   mux->stream = stream;
+   bson_mutex_init (&mux->mutex);
+   mongoc_cond_init (&mux->cond);
+   _mongoc_array_init (&mux->subscribers, sizeof (mongoc_change_stream_subscriber_t *));
+   bson_init (&mux->error_doc);
+
+   return mux;
+}
+
+
+void
+mongoc_change_stream_mux_destroy (mongoc_change_stream_mux_t *mux)
+{
+   if (!mux) {
+      return;
+   }
+
+   /* subscribers refer to the mux, they must be destroyed first */
+   BSON_ASSERT (mux->subscribers.len == 0);
+
+   mongoc_change_stream_destroy (mux->stream);
+   bson_mutex_destroy (&mux->mutex);
+   mongoc_cond_destroy (&mux->cond);
+   _mongoc_array_destroy (&mux->subscribers);
+   bson_destroy (&mux->error_doc);
+   bson_free (mux);
+}
+
+
+/* Wait for any thread that is pumping @mux. Called with the mutex held. */
+static void
+_mux_wait_for_pump (mongoc_change_stream_mux_t *mux)
+{
+   while (mux->pumping) {
+      mongoc_cond_wait (&mux->cond, &mux->mutex);
+   }
+}
+
+
+static void
+_subscriber_set_resume_token (mongoc_change_stream_subscriber_t *subscriber, const bson_t *resume_token)
+{
+   bson_reinit (&subscriber->resume_token);
+   if (resume_token) {
+      bson_concat (&subscriber->resume_token, resume_token);
+   }
+}
+
+
+/* Queue @event for each subscriber whose filter accepts it. Called with the
+ * mutex held. */
+static void
+_mux_dispatch (mongoc_change_stream_mux_t *mux, const bson_t *event)
+{
+   for (size_t i = 0; i < mux->subscribers.len; i++) {
+      mongoc_change_stream_subscriber_t *subscriber =
+         _mongoc_array_index (&mux->subscribers, mongoc_change_stream_subscriber_t *, i);
+
+      if (subscriber->error.code) {
+         continue;
+      }
+
+      if (subscriber->filter && !subscriber->filter (event, subscriber->filter_ctx)) {
+         continue;
+      }
+
+      if (subscriber->max_queued && _mongoc_queue_get_length (&subscriber->queue) >= subscriber->max_queued) {
+         /* the subscriber has fallen behind. It can open its own change
+          * stream from its resume token to catch up. */
+         bson_set_error (&subscriber->error,
+                         MONGOC_ERROR_CURSOR,
+                         MONGOC_ERROR_CURSOR_INVALID_CURSOR,
+                         "Change stream subscriber has more than %" PRIu32 " queued events",
+                         subscriber->max_queued);
+         continue;
+      }
+
+      _mongoc_queue_push_tail (&subscriber->queue, bson_copy (event));
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mux_pump --
+ *
+ *       Read one event from the change stream and queue it for the
+ *       subscribers it matches. Subscribers that have nothing queued
+ *       take the resume token of the change stream, so they resume past
+ *       events that their filters skipped.
+ *
+ *       Called with the mutex held and no other thread pumping. The
+ *       mutex is released while waiting for the server.
+ *
+ * Returns:
+ *       true if an event was read.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mux_pump (mongoc_change_stream_mux_t *mux)
+{
+   const bson_t *event;
+   const bson_t *error_doc;
+   bson_error_t error;
+   bool ret;
+
+   BSON_ASSERT (!mux->pumping);
+   mux->pumping = true;
+
+   bson_mutex_unlock (&mux->mutex);
+   ret = mongoc_change_stream_next (mux->stream, &event);
+   bson_mutex_lock (&mux->mutex);
+
+   if (ret) {
+      _mux_dispatch (mux, event);
+   } else if (mongoc_change_stream_error_document (mux->stream, &error, &error_doc)) {
+      mux->error = error;
+      bson_reinit (&mux->error_doc);
+      if (error_doc) {
+         bson_concat (&mux->error_doc, error_doc);
+      }
+   }
+
+   for (size_t i = 0; i < mux->subscribers.len; i++) {
+      mongoc_change_stream_subscriber_t *subscriber =
+         _mongoc_array_index (&mux->subscribers, mongoc_change_stream_subscriber_t *, i);
+
+      if (_mongoc_queue_get_length (&subscriber->queue) == 0) {
+         _subscriber_set_resume_token (subscriber, mongoc_change_stream_get_resume_token (mux->stream));
+      }
+   }
+
+   mux->pumping = false;
+   mongoc_cond_broadcast (&mux->cond);
+
+   return ret;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_change_stream_mux_subscribe --
+ *
+ *       Add a subscriber to @mux that receives the events after this
+ *       call for which @filter returns true. @filter is passed each event
+ *       and @filter_ctx, with the mux locked, on the thread that reads
+ *       the change stream. A NULL @filter accepts every event.
+ *
+ *       If more than @max_queued events are waiting for the subscriber,
+ *       it fails and receives no more events. 0 means no limit.
+ *
+ * Returns:
+ *       A mongoc_change_stream_subscriber_t to be freed with
+ *       mongoc_change_stream_subscriber_destroy.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_change_stream_subscriber_t *
+mongoc_change_stream_mux_subscribe (mongoc_change_stream_mux_t *mux,
+                                    mongoc_change_stream_filter_cb_t filter,
+                                    void *filter_ctx,
+                                    uint32_t max_queued)
+{
+   mongoc_change_stream_subscriber_t *subscriber;
+
+   BSON_ASSERT_PARAM (mux);
+
+   subscriber = BSON_ALIGNED_ALLOC0 (mongoc_change_stream_subscriber_t);
+   subscriber->mux = mux;
+   subscriber->filter = filter;
+   subscriber->filter_ctx = filter_ctx;
+   subscriber->max_queued = max_queued;
+   _mongoc_queue_init (&subscriber->queue);
+   bson_init (&subscriber->resume_token);
+
+   bson_mutex_lock (&mux->mutex);
+   _mux_wait_for_pump (mux);
+   _subscriber_set_resume_token (subscriber, mongoc_change_stream_get_resume_token (mux->stream));
+   _mongoc_array_append_val (&mux->subscribers, subscriber);
+   bson_mutex_unlock (&mux->mutex);
+
+   return subscriber;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_change_stream_subscriber_next --
+ *
+ *       Return the next event queued for @subscriber. If there is none,
+ *       read events from the change stream until one matches
+ *       @subscriber or the server has none. Only one thread reads from
+ *       the change stream at a time; the others wait for it.
+ *
+ * Returns:
+ *       true and @bson is set to an event that is valid until the next
+ *       call, or false and @bson is set to NULL.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+mongoc_change_stream_subscriber_next (mongoc_change_stream_subscriber_t *subscriber, const bson_t **bson)
+{
+   mongoc_change_stream_mux_t *mux;
+   bson_iter_t iter;
+
+   BSON_ASSERT_PARAM (subscriber);
+   BSON_ASSERT_PARAM (bson);
+
+   mux = subscriber->mux;
+   *bson = NULL;
+
+   bson_mutex_lock (&mux->mutex);
+
+   bson_destroy (subscriber->current);
+   subscriber->current = NULL;
+
+   while (!subscriber->error.code) {
+      subscriber->current = _mongoc_queue_pop_head (&subscriber->queue);
+      if (subscriber->current) {
+         if (bson_iter_init_find (&iter, subscriber->current, "_id") && BSON_ITER_HOLDS_DOCUMENT (&iter)) {
+            const uint8_t *data;
+            uint32_t len;
+            bson_t resume_token;
+
+            bson_iter_document (&iter, &len, &data);
+            BSON_ASSERT (bson_init_static (&resume_token, data, len));
+            _subscriber_set_resume_token (subscriber, &resume_token);
+         }
+
+         *bson = subscriber->current;
+         break;
+      }
+
+      if (mux->error.code) {
+         break;
+      }
+
+      if (mux->pumping) {
+         _mux_wait_for_pump (mux);
+         continue;
+      }
+
+      if (!_mux_pump (mux)) {
+         break;
+      }
+   }
+
+   bson_mutex_unlock (&mux->mutex);
+
+   return *bson != NULL;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_change_stream_subscriber_get_resume_token --
+ *
+ *       Return the resume token after the last event returned to
+ *       @subscriber, or after the events its filter skipped if it has
+ *       none queued.
+ *
+ * Returns:
+ *       The resume token, valid until the next call with @subscriber, or
+ *       NULL if there is none.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+const bson_t *
+mongoc_change_stream_subscriber_get_resume_token (const mongoc_change_stream_subscriber_t *subscriber)
+{
+   BSON_ASSERT_PARAM (subscriber);
+
+   return bson_empty (&subscriber->resume_token) ? NULL : &subscriber->resume_token;
+}
+
+
+bool
+mongoc_change_stream_subscriber_error_document (const mongoc_change_stream_subscriber_t *subscriber,
+                                                bson_error_t *error,
+                                                const bson_t **doc)
+{
+   mongoc_change_stream_mux_t *mux;
+   bool ret = false;
+
+   BSON_ASSERT_PARAM (subscriber);
+
+   mux = subscriber->mux;
+
+   if (doc) {
+      *doc = NULL;
+   }
+
+   bson_mutex_lock (&mux->mutex);
+
+   if (subscriber->error.code) {
+      if (error) {
+         *error = subscriber->error;
+      }
+      ret = true;
+   } else if (mux->error.code) {
+      if (error) {
+         *error = mux->error;
+      }
+      if (doc) {
+         *doc = &mux->error_doc;
+      }
+      ret = true;
+   }
+
+   bson_mutex_unlock (&mux->mutex);
+
+   return ret;
+}
+
+
+void
+mongoc_change_stream_subscriber_destroy (mongoc_change_stream_subscriber_t *subscriber)
+{
+   mongoc_change_stream_mux_t *mux;
+   bson_t *event;
+
+   if (!subscriber) {
+      return;
+   }
+
+   mux = subscriber->mux;
+
+   bson_mutex_lock (&mux->mutex);
+   for (size_t i = 0; i < mux->subscribers.len; i++) {
+      if (_mongoc_array_index (&mux->subscribers, mongoc_change_stream_subscriber_t *, i) == subscriber) {
+         /* move the last subscriber into this one's slot */
+         _mongoc_array_index (&mux->subscribers, mongoc_change_stream_subscriber_t *, i) =
+            _mongoc_array_index (&mux->subscribers, mongoc_change_stream_subscriber_t *, mux->subscribers.len - 1);
+         mux->subscribers.len--;
+         break;
+      }
+   }
+   bson_mutex_unlock (&mux->mutex);
+
+   while ((event = _mongoc_queue_pop_head (&subscriber->queue))) {
+      bson_destroy (event);
+   }
+
+   bson_destroy (subscriber->current);
+   bson_destroy (&subscriber->resume_token);
+   bson_free (subscriber);
+}
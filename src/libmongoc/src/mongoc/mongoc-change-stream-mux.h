@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mongoc-prelude.h"
+
+#ifndef MONGOC_CHANGE_STREAM_MUX_H
+#define MONGOC_CHANGE_STREAM_MUX_H
+
+#include <bson/bson.h>
+
+#include "mongoc-macros.h"
+#include "mongoc-change-stream.h"
+
+BSON_BEGIN_DECLS
+
+typedef struct _mongoc_change_stream_mux_t mongoc_change_stream_mux_t;
+typedef struct _mongoc_change_stream_subscriber_t mongoc_change_stream_subscriber_t;
+typedef bool (*mongoc_change_stream_filter_cb_t) (const bson_t *event, void *ctx);
+
+MONGOC_EXPORT (mongoc_change_stream_mux_t *)
+mongoc_change_stream_mux_new (mongoc_change_stream_t *stream) BSON_GNUC_WARN_UNUSED_RESULT;
+
+MONGOC_EXPORT (void)
+mongoc_change_stream_mux_destroy (mongoc_change_stream_mux_t *mux);
+
+MONGOC_EXPORT (mongoc_change_stream_subscriber_t *)
+mongoc_change_stream_mux_subscribe (mongoc_change_stream_mux_t *mux,
+                                    mongoc_change_stream_filter_cb_t filter,
+                                    void *filter_ctx,
+                                    uint32_t max_queued) BSON_GNUC_WARN_UNUSED_RESULT;
+
+MONGOC_EXPORT (bool)
+mongoc_change_stream_subscriber_next (mongoc_change_stream_subscriber_t *subscriber, const bson_t **bson);
+
+MONGOC_EXPORT (const bson_t *)
+mongoc_change_stream_subscriber_get_resume_token (const mongoc_change_stream_subscriber_t *subscriber);
+
+MONGOC_EXPORT (bool)
+mongoc_change_stream_subscriber_error_document (const mongoc_change_stream_subscriber_t *subscriber,
+                                                bson_error_t *error,
+                                                const bson_t **doc);
+
+MONGOC_EXPORT (void)
+mongoc_change_stream_subscriber_destroy (mongoc_change_stream_subscriber_t *subscriber);
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_CHANGE_STREAM_MUX_H */
@@ -37,6 +37,11 @@ mongoc_client_pool_num_pushed (mongoc_client_pool_t *pool);
 mongoc_topology_t *
 _mongoc_client_pool_get_topology (mongoc_client_pool_t *pool);
 
+void
+_mongoc_client_pool_shared_topologies_init (void);
+void
+_mongoc_client_pool_shared_topologies_cleanup (void);
+
 BSON_END_DECLS
 
 
@@ -18,6 +18,7 @@
 #include "mongoc.h"
 #include "mongoc-apm-private.h"
 #include "mongoc-array-private.h"
+#include "mongoc-bulk-operation-private.h"
 #include "mongoc-counters-private.h"
 #include "mongoc-client-pool-private.h"
 #include "mongoc-client-pool.h"
@@ -28,11 +29,38 @@
 #include "mongoc-topology-private.h"
 #include "mongoc-topology-background-monitoring-private.h"
 #include "mongoc-trace-private.h"
+#include "mongoc-util-private.h"
+#include "mongoc-write-command-private.h"
+#include "utlist.h"
 
 #ifdef MONGOC_ENABLE_SSL
 #include "mongoc-ssl-private.h"
 #endif
 
+/* A topology shared by all pools created with mongoc_client_pool_new_shared
+ * for equivalent URIs. Entries live in g_shared_topologies and are guarded by
+ * g_shared_topologies_mutex. */
+typedef struct _mongoc_shared_topology_t {
+   struct _mongoc_shared_topology_t *next;
+   /* Identifies the deployment: the URI with pool-only options removed. */
+   bson_t key;
+   mongoc_topology_t *topology;
+   /* Number of pools referencing this topology. */
+   uint32_t refcount;
+   /* Set once SDAM callbacks are installed on the topology. They are never
+    * replaced or cleared, since server monitors keep their own copy. */
+   bool apm_callbacks_set;
+#ifdef MONGOC_ENABLE_SSL
+   /* The scanner refers to these options, so they are owned by the entry
+    * rather than by any one pool that may be destroyed before the topology.
+    * They may only change before monitoring starts. */
+   mongoc_ssl_opt_t ssl_opts;
+#endif
+} mongoc_shared_topology_t;
+
+static mongoc_shared_topology_t *g_shared_topologies;
+static bson_mutex_t g_shared_topologies_mutex;
+
 struct _mongoc_client_pool_t {
    bson_mutex_t mutex;
    mongoc_cond_t cond;
@@ -55,12 +83,227 @@ struct _mongoc_client_pool_t {
    bool client_initialized;
    // `last_known_serverids` is a sorted array of uint32_t.
    mongoc_array_t last_known_serverids;
+   // `shared` is set if the topology is shared with other pools. See mongoc_client_pool_new_shared.
+   mongoc_shared_topology_t *shared;
+   // `insert_groups` coalesces mongoc_client_pool_insert_one calls per namespace. Guarded by `mutex`.
+   struct _insert_group_t *insert_groups;
+   mongoc_cond_t insert_cond;
+   // `warm_up_size` is the number of pooled clients kept connected to every server. See
+   // mongoc_client_pool_set_warm_up_size. It and the other `warm_up_` fields are guarded by `mutex`.
+   uint32_t warm_up_size;
+   bool warm_up_started;
+   bool warm_up_shutdown;
+   bson_thread_t warm_up_thread;
+   mongoc_cond_t warm_up_cond;
 };
 
 
-#ifdef MONGOC_ENABLE_SSL
+static void
+_insert_groups_destroy (mongoc_client_pool_t *pool);
+
+static bool
+_warm_up_start_if_needed (mongoc_client_pool_t *pool, bson_error_t *error);
+
+static void
+_warm_up_stop (mongoc_client_pool_t *pool);
+
+static void
+_warm_up_start_or_log (mongoc_client_pool_t *pool);
+
+
 void
-mongoc_client_pool_set_ssl_opts (mongoc_client_pool_t *pool, const mongoc_ssl_opt_t *opts)
+_mongoc_client_pool_shared_topologies_init (void)
+{
+   bson_mutex_init (&g_shared_topologies_mutex);
+}
+
+
+void
+_mongoc_client_pool_shared_topologies_cleanup (void)
+{
+   bson_mutex_destroy (&g_shared_topologies_mutex);
+}
+
+
+static void
+_append_utf8_or_empty (bson_t *bson, const char *key, const char *value)
+{
+   BSON_ASSERT (bson_append_utf8 (bson, key, -1, value ? value : "", -1));
+}
+
+
+/* Build the key identifying the deployment `uri` refers to. Options that only
+ * configure the pool itself are excluded, so pools that differ only in their
+ * sizing share a topology. */
+static void
+_shared_topology_key (const mongoc_uri_t *uri, bson_t *key)
+{
+   const mongoc_host_list_t *host;
+   bson_t hosts;
+   bson_t options;
+   uint32_t i = 0;
+
+   bson_init (key);
+
+   _append_utf8_or_empty (key, "srv", mongoc_uri_get_srv_hostname (uri));
+   _append_utf8_or_empty (key, "username", mongoc_uri_get_username (uri));
+   _append_utf8_or_empty (key, "password", mongoc_uri_get_password (uri));
+   _append_utf8_or_empty (key, "database", mongoc_uri_get_database (uri));
+
+   BSON_ASSERT (BSON_APPEND_ARRAY_BEGIN (key, "hosts", &hosts));
+   for (host = mongoc_uri_get_hosts (uri); host; host = host->next) {
+      const char *idx;
+      char buf[16];
+
+      bson_uint32_to_string (i++, &idx, buf, sizeof buf);
+      _append_utf8_or_empty (&hosts, idx, host->host_and_port);
+   }
+   BSON_ASSERT (bson_append_array_end (key, &hosts));
+
+   BSON_ASSERT (BSON_APPEND_DOCUMENT (key, "credentials", mongoc_uri_get_credentials (uri)));
+   BSON_ASSERT (BSON_APPEND_DOCUMENT (key, "compressors", mongoc_uri_get_compressors (uri)));
+
+   bson_init (&options);
+   bson_copy_to_excluding_noinit (mongoc_uri_get_options (uri),
+                                  &options,
+                                  MONGOC_URI_MAXPOOLSIZE,
+                                  MONGOC_URI_MINPOOLSIZE,
+                                  MONGOC_URI_WAITQUEUETIMEOUTMS,
+                                  NULL);
+   BSON_ASSERT (BSON_APPEND_DOCUMENT (key, "options", &options));
+   bson_destroy (&options);
+}
+
+
+/* Settings read by server monitors may only change before monitoring starts.
+ *
+ * This function assumes the topology's tpld_modification_mtx is locked, so
+ * that monitors cannot be created concurrently.
+ */
+static bool
+_shared_topology_monitoring_started (mongoc_topology_t *topology)
+{
+   return bson_atomic_int_fetch (&topology->scanner_state, bson_memory_order_relaxed) != MONGOC_TOPOLOGY_SCANNER_OFF;
+}
+
+
+static void
+_shared_topology_destroy (mongoc_shared_topology_t *shared)
+{
+   if (!shared) {
+      return;
+   }
+
+   bson_destroy (&shared->key);
+#ifdef MONGOC_ENABLE_SSL
+   _mongoc_ssl_opts_cleanup (&shared->ssl_opts, true);
+#endif
+   bson_free (shared);
+}
+
+
+/* Return the registered topology for `uri` with a new reference, creating and
+ * registering one if needed. Returns NULL and sets `error` if a new topology
+ * could not be created. */
+static mongoc_shared_topology_t *
+_shared_topology_acquire (const mongoc_uri_t *uri, bson_error_t *error)
+{
+   mongoc_shared_topology_t *shared;
+   mongoc_topology_t *topology;
+   const char *appname;
+   bson_t key;
+
+   _shared_topology_key (uri, &key);
+
+   bson_mutex_lock (&g_shared_topologies_mutex);
+
+   LL_FOREACH (g_shared_topologies, shared)
+   {
+      if (bson_equal (&shared->key, &key)) {
+         shared->refcount++;
+         GOTO (done);
+      }
+   }
+
+   topology = mongoc_topology_new (uri, false);
+
+   if (!topology->valid) {
+      if (error) {
+         memcpy (error, &topology->scanner->error, sizeof (bson_error_t));
+      }
+
+      mongoc_topology_destroy (topology);
+      shared = NULL;
+      GOTO (done);
+   }
+
+   shared = BSON_ALIGNED_ALLOC0 (mongoc_shared_topology_t);
+   bson_copy_to (&key, &shared->key);
+   shared->topology = topology;
+   shared->refcount = 1;
+
+   /* Configure the topology from the URI before other pools can see it. The
+    * appname and TLS options are part of the key, so they apply to every
+    * pool sharing the topology. */
+   appname = mongoc_uri_get_option_as_utf8 (topology->uri, MONGOC_URI_APPNAME, NULL);
+   if (appname) {
+      /* the appname should have already been validated */
+      BSON_ASSERT (_mongoc_topology_set_appname (topology, appname));
+   }
+
+#ifdef MONGOC_ENABLE_SSL
+   if (mongoc_uri_get_tls (topology->uri)) {
+      mongoc_ssl_opt_t ssl_opt = {0};
+      _mongoc_internal_tls_opts_t internal_tls_opts = {0};
+
+      _mongoc_ssl_opts_from_uri (&ssl_opt, &internal_tls_opts, topology->uri);
+      _mongoc_ssl_opts_copy_to (&ssl_opt, &shared->ssl_opts, true /* copy internal opts. */);
+      mongoc_topology_scanner_set_ssl_opts (topology->scanner, &shared->ssl_opts);
+   }
+#endif
+
+   LL_PREPEND (g_shared_topologies, shared);
+
+done:
+   bson_mutex_unlock (&g_shared_topologies_mutex);
+   bson_destroy (&key);
+
+   return shared;
+}
+
+
+#ifdef MONGOC_ENABLE_SSL
+/* Point the topology scanner at the pool's TLS options. A shared topology
+ * outlives individual pools, so the scanner is given a copy owned by the
+ * shared entry instead. Once the shared topology is monitoring, its options
+ * are left untouched and only apply to the pool's own clients.
+ *
+ * This function assumes the pool's mutex is locked
+ */
+static void
+_set_scanner_ssl_opts (mongoc_client_pool_t *pool)
+{
+   mongoc_shared_topology_t *const shared = pool->shared;
+   mongoc_topology_t *const topology = pool->topology;
+
+   if (!shared) {
+      mongoc_topology_scanner_set_ssl_opts (topology->scanner, &pool->ssl_opts);
+      return;
+   }
+
+   bson_mutex_lock (&g_shared_topologies_mutex);
+   bson_mutex_lock (&topology->tpld_modification_mtx);
+   if (!_shared_topology_monitoring_started (topology)) {
+      _mongoc_ssl_opts_cleanup (&shared->ssl_opts, true);
+      _mongoc_ssl_opts_copy_to (&pool->ssl_opts, &shared->ssl_opts, true /* copy internal opts. */);
+      mongoc_topology_scanner_set_ssl_opts (topology->scanner, &shared->ssl_opts);
+   }
+   bson_mutex_unlock (&topology->tpld_modification_mtx);
+   bson_mutex_unlock (&g_shared_topologies_mutex);
+}
+
+static void
+_client_pool_set_ssl_opts (mongoc_client_pool_t *pool, const mongoc_ssl_opt_t *opts, bool set_scanner)
 {
    BSON_ASSERT_PARAM (pool);
 
@@ -75,11 +318,19 @@ mongoc_client_pool_set_ssl_opts (mongoc_client_pool_t *pool, const mongoc_ssl_op
       pool->ssl_opts_set = true;
    }
 
-   mongoc_topology_scanner_set_ssl_opts (pool->topology->scanner, &pool->ssl_opts);
+   if (set_scanner) {
+      _set_scanner_ssl_opts (pool);
+   }
 
    bson_mutex_unlock (&pool->mutex);
 }
 
+void
+mongoc_client_pool_set_ssl_opts (mongoc_client_pool_t *pool, const mongoc_ssl_opt_t *opts)
+{
+   _client_pool_set_ssl_opts (pool, opts, true);
+}
+
 void
 _mongoc_client_pool_set_internal_tls_opts (mongoc_client_pool_t *pool, _mongoc_internal_tls_opts_t *internal)
 {
@@ -111,20 +362,9 @@ mongoc_client_pool_new (const mongoc_uri_t *uri)
 }
 
 
-mongoc_client_pool_t *
-mongoc_client_pool_new_with_error (const mongoc_uri_t *uri, bson_error_t *error)
+static bool
+_check_tls_supported (const mongoc_uri_t *uri, bson_error_t *error)
 {
-   mongoc_topology_t *topology;
-   mongoc_client_pool_t *pool;
-   const bson_t *b;
-   bson_iter_t iter;
-   const char *appname;
-
-
-   ENTRY;
-
-   BSON_ASSERT (uri);
-
 #ifndef MONGOC_ENABLE_SSL
    if (mongoc_uri_get_tls (uri)) {
       bson_set_error (error,
@@ -132,32 +372,49 @@ mongoc_client_pool_new_with_error (const mongoc_uri_t *uri, bson_error_t *error)
                       MONGOC_ERROR_COMMAND_INVALID_ARG,
                       "Can't create SSL client pool, SSL not enabled in this "
                       "build.");
-      return NULL;
+      return false;
    }
+#else
+   BSON_UNUSED (uri);
+   BSON_UNUSED (error);
 #endif
 
-   topology = mongoc_topology_new (uri, false);
+   return true;
+}
 
-   if (!topology->valid) {
-      if (error) {
-         memcpy (error, &topology->scanner->error, sizeof (bson_error_t));
-      }
 
-      mongoc_topology_destroy (topology);
+/* Create a pool using `topology`, which must be valid. If `shared` is set,
+ * `topology` belongs to it and the pool takes over the reference the caller
+ * acquired. */
+static mongoc_client_pool_t *
+_mongoc_client_pool_new_with_topology (const mongoc_uri_t *uri,
+                                       mongoc_topology_t *topology,
+                                       mongoc_shared_topology_t *shared)
+{
+   mongoc_client_pool_t *pool;
+   const bson_t *b;
+   bson_iter_t iter;
+   const char *appname;
 
-      RETURN (NULL);
-   }
+   ENTRY;
+
+   BSON_ASSERT_PARAM (uri);
+   BSON_ASSERT_PARAM (topology);
+   BSON_OPTIONAL_PARAM (shared);
 
    pool = (mongoc_client_pool_t *) bson_malloc0 (sizeof *pool);
    _mongoc_array_init (&pool->last_known_serverids, sizeof (uint32_t));
    bson_mutex_init (&pool->mutex);
    mongoc_cond_init (&pool->cond);
+   mongoc_cond_init (&pool->insert_cond);
+   mongoc_cond_init (&pool->warm_up_cond);
    _mongoc_queue_init (&pool->queue);
    pool->uri = mongoc_uri_copy (uri);
    pool->min_pool_size = 0;
    pool->max_pool_size = 100;
    pool->size = 0;
    pool->topology = topology;
+   pool->shared = shared;
    pool->error_api_version = MONGOC_ERROR_API_VERSION_LEGACY;
 
    b = mongoc_uri_get_options (pool->uri);
@@ -177,8 +434,10 @@ mongoc_client_pool_new_with_error (const mongoc_uri_t *uri, bson_error_t *error)
       }
    }
 
+   /* A shared topology was already configured from the URI when it was
+    * created. */
    appname = mongoc_uri_get_option_as_utf8 (pool->uri, MONGOC_URI_APPNAME, NULL);
-   if (appname) {
+   if (appname && !shared) {
       /* the appname should have already been validated */
       BSON_ASSERT (mongoc_client_pool_set_appname (pool, appname));
    }
@@ -190,7 +449,7 @@ mongoc_client_pool_new_with_error (const mongoc_uri_t *uri, bson_error_t *error)
 
       _mongoc_ssl_opts_from_uri (&ssl_opt, &internal_tls_opts, pool->uri);
       /* sets use_ssl = true */
-      mongoc_client_pool_set_ssl_opts (pool, &ssl_opt);
+      _client_pool_set_ssl_opts (pool, &ssl_opt, !shared /* set_scanner */);
       _mongoc_client_pool_set_internal_tls_opts (pool, &internal_tls_opts);
    }
 #endif
@@ -200,32 +459,164 @@ mongoc_client_pool_new_with_error (const mongoc_uri_t *uri, bson_error_t *error)
 }
 
 
-void
-mongoc_client_pool_destroy (mongoc_client_pool_t *pool)
+mongoc_client_pool_t *
+mongoc_client_pool_new_with_error (const mongoc_uri_t *uri, bson_error_t *error)
 {
-   mongoc_client_t *client;
+   mongoc_topology_t *topology;
 
    ENTRY;
 
-   if (!pool) {
-      EXIT;
+   BSON_ASSERT (uri);
+
+   if (!_check_tls_supported (uri, error)) {
+      RETURN (NULL);
+   }
+
+   topology = mongoc_topology_new (uri, false);
+
+   if (!topology->valid) {
+      if (error) {
+         memcpy (error, &topology->scanner->error, sizeof (bson_error_t));
+      }
+
+      mongoc_topology_destroy (topology);
+
+      RETURN (NULL);
+   }
+
+   RETURN (_mongoc_client_pool_new_with_topology (uri, topology, NULL));
+}
+
+
+mongoc_client_pool_t *
+mongoc_client_pool_new_shared (const mongoc_uri_t *uri, bson_error_t *error)
+{
+   mongoc_shared_topology_t *shared;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM (uri);
+
+   if (!_check_tls_supported (uri, error)) {
+      RETURN (NULL);
+   }
+
+   if (!(shared = _shared_topology_acquire (uri, error))) {
+      RETURN (NULL);
+   }
+
+   RETURN (_mongoc_client_pool_new_with_topology (uri, shared->topology, shared));
+}
+
+
+/* Drop `pool`'s reference to its shared topology if it is the last one.
+ * Returns true if the reference was dropped, in which case the topology is no
+ * longer registered and the caller is responsible for destroying it. */
+static bool
+_shared_topology_release_if_last (mongoc_client_pool_t *pool)
+{
+   mongoc_shared_topology_t *const shared = pool->shared;
+   bool released = false;
+
+   bson_mutex_lock (&g_shared_topologies_mutex);
+   if (shared->refcount == 1) {
+      shared->refcount = 0;
+      LL_DELETE (g_shared_topologies, shared);
+      released = true;
+   }
+   bson_mutex_unlock (&g_shared_topologies_mutex);
+
+   return released;
+}
+
+
+/* Drop `pool`'s reference to its shared topology. Returns true if it was the
+ * last reference, in which case the caller is responsible for destroying the
+ * topology. */
+static bool
+_shared_topology_release (mongoc_client_pool_t *pool)
+{
+   mongoc_shared_topology_t *const shared = pool->shared;
+   bool last;
+
+   bson_mutex_lock (&g_shared_topologies_mutex);
+
+   BSON_ASSERT (shared->refcount > 0);
+   last = --shared->refcount == 0;
+   if (last) {
+      LL_DELETE (g_shared_topologies, shared);
    }
 
+   bson_mutex_unlock (&g_shared_topologies_mutex);
+
+   return last;
+}
+
+
+static void
+_end_sessions_if_needed (mongoc_client_pool_t *pool)
+{
+   mongoc_client_t *client;
+
    if (!mongoc_server_session_pool_is_empty (pool->topology->session_pool)) {
       client = mongoc_client_pool_pop (pool);
       _mongoc_client_end_sessions (client);
       mongoc_client_pool_push (pool, client);
    }
+}
+
+
+static void
+_destroy_pooled_clients (mongoc_client_pool_t *pool)
+{
+   mongoc_client_t *client;
 
    while ((client = (mongoc_client_t *) _mongoc_queue_pop_head (&pool->queue))) {
       mongoc_client_destroy (client);
    }
+}
+
+
+void
+mongoc_client_pool_destroy (mongoc_client_pool_t *pool)
+{
+   bool last_ref;
+
+   ENTRY;
+
+   if (!pool) {
+      EXIT;
+   }
+
+   _warm_up_stop (pool);
+
+   last_ref = !pool->shared || _shared_topology_release_if_last (pool);
+
+   if (last_ref) {
+      _end_sessions_if_needed (pool);
+   }
+
+   _destroy_pooled_clients (pool);
+
+   if (!last_ref && _shared_topology_release (pool)) {
+      /* Other pools released the topology while our clients were destroyed. */
+      last_ref = true;
+      _end_sessions_if_needed (pool);
+      _destroy_pooled_clients (pool);
+   }
+
+   if (last_ref) {
+      mongoc_topology_destroy (pool->topology);
+      _shared_topology_destroy (pool->shared);
+   }
 
-   mongoc_topology_destroy (pool->topology);
+   _insert_groups_destroy (pool);
 
    mongoc_uri_destroy (pool->uri);
    bson_mutex_destroy (&pool->mutex);
    mongoc_cond_destroy (&pool->cond);
+   mongoc_cond_destroy (&pool->insert_cond);
+   mongoc_cond_destroy (&pool->warm_up_cond);
 
    mongoc_server_api_destroy (pool->api);
 
@@ -276,6 +667,17 @@ _initialize_new_client (mongoc_client_pool_t *pool, mongoc_client_t *client)
 
    client->api = mongoc_server_api_copy (pool->api);
 
+   if (pool->shared) {
+      /* The client was created from the topology's URI, which belongs to the
+       * first pool that shared it. Apply this pool's own settings. */
+      mongoc_uri_set_read_prefs_t (client->uri, mongoc_uri_get_read_prefs_t (pool->uri));
+      mongoc_uri_set_read_concern (client->uri, mongoc_uri_get_read_concern (pool->uri));
+      mongoc_uri_set_write_concern (client->uri, mongoc_uri_get_write_concern (pool->uri));
+      mongoc_client_set_read_prefs (client, mongoc_uri_get_read_prefs_t (pool->uri));
+      mongoc_client_set_read_concern (client, mongoc_uri_get_read_concern (pool->uri));
+      mongoc_client_set_write_concern (client, mongoc_uri_get_write_concern (pool->uri));
+   }
+
 #ifdef MONGOC_ENABLE_SSL
    if (pool->ssl_opts_set) {
       mongoc_client_set_ssl_opts (client, &pool->ssl_opts);
@@ -328,6 +730,7 @@ again:
    }
 
    _start_scanner_if_needed (pool);
+   _warm_up_start_or_log (pool);
 done:
    bson_mutex_unlock (&pool->mutex);
 
@@ -357,6 +760,7 @@ mongoc_client_pool_try_pop (mongoc_client_pool_t *pool)
 
    if (client) {
       _start_scanner_if_needed (pool);
+      _warm_up_start_or_log (pool);
    }
    bson_mutex_unlock (&pool->mutex);
 
@@ -568,11 +972,20 @@ mongoc_client_pool_set_apm_callbacks (mongoc_client_pool_t *pool, mongoc_apm_cal
    BSON_ASSERT_PARAM (pool);
 
    mongoc_topology_t *const topology = BSON_ASSERT_PTR_INLINE (pool)->topology;
+
+   // Lock the registry before the topology, as _set_scanner_ssl_opts does.
+   if (pool->shared) {
+      bson_mutex_lock (&g_shared_topologies_mutex);
+   }
+
    mc_tpld_modification tdmod = mc_tpld_modify_begin (topology);
 
    // Prevent setting callbacks more than once
    if (pool->apm_callbacks_set) {
       mc_tpld_modify_drop (tdmod);
+      if (pool->shared) {
+         bson_mutex_unlock (&g_shared_topologies_mutex);
+      }
       MONGOC_ERROR ("Can only set callbacks once");
       return false;
    }
@@ -586,7 +999,14 @@ mongoc_client_pool_set_apm_callbacks (mongoc_client_pool_t *pool, mongoc_apm_cal
    pool->apm_context = context;
 
    // Update callbacks on the topology
-   mongoc_topology_set_apm_callbacks (topology, tdmod.new_td, callbacks, context);
+   if (!pool->shared) {
+      mongoc_topology_set_apm_callbacks (topology, tdmod.new_td, callbacks, context);
+   } else if (!pool->shared->apm_callbacks_set && !_shared_topology_monitoring_started (topology)) {
+      // A shared topology reports SDAM events to the first pool that sets callbacks before monitoring starts.
+      // Server monitors copy the callbacks, so they are kept until the topology is destroyed.
+      mongoc_topology_set_apm_callbacks (topology, tdmod.new_td, callbacks, context);
+      pool->shared->apm_callbacks_set = true;
+   }
 
    // Signal that we have already set the callbacks
    pool->apm_callbacks_set = true;
@@ -594,6 +1014,10 @@ mongoc_client_pool_set_apm_callbacks (mongoc_client_pool_t *pool, mongoc_apm_cal
    // Save our updated topology
    mc_tpld_modify_commit (tdmod);
 
+   if (pool->shared) {
+      bson_mutex_unlock (&g_shared_topologies_mutex);
+   }
+
    return true;
 }
 
@@ -639,13 +1063,74 @@ mongoc_client_pool_enable_auto_encryption (mongoc_client_pool_t *pool,
 {
    BSON_ASSERT_PARAM (pool);
 
+   if (pool->shared) {
+      bson_set_error (error,
+                      MONGOC_ERROR_CLIENT,
+                      MONGOC_ERROR_CLIENT_INVALID_ENCRYPTION_STATE,
+                      "Automatic encryption cannot be enabled on a pool with a shared topology");
+      return false;
+   }
+
    return _mongoc_cse_client_pool_enable_auto_encryption (pool->topology, opts, error);
 }
 
-bool
-mongoc_client_pool_set_server_api (mongoc_client_pool_t *pool, const mongoc_server_api_t *api, bson_error_t *error)
+static bool
+_server_api_equal (const mongoc_server_api_t *a, const mongoc_server_api_t *b)
 {
-   BSON_ASSERT_PARAM (pool);
+   const mongoc_optional_t *a_strict = mongoc_server_api_get_strict (a);
+   const mongoc_optional_t *b_strict = mongoc_server_api_get_strict (b);
+   const mongoc_optional_t *a_deprecation_errors = mongoc_server_api_get_deprecation_errors (a);
+   const mongoc_optional_t *b_deprecation_errors = mongoc_server_api_get_deprecation_errors (b);
+
+   return mongoc_server_api_get_version (a) == mongoc_server_api_get_version (b) &&
+          mongoc_optional_is_set (a_strict) == mongoc_optional_is_set (b_strict) &&
+          mongoc_optional_value (a_strict) == mongoc_optional_value (b_strict) &&
+          mongoc_optional_is_set (a_deprecation_errors) == mongoc_optional_is_set (b_deprecation_errors) &&
+          mongoc_optional_value (a_deprecation_errors) == mongoc_optional_value (b_deprecation_errors);
+}
+
+/* All pools sharing a topology must declare the same server API as its
+ * monitors. The first pool to declare one sets it, before monitoring starts. */
+static bool
+_shared_topology_set_server_api (mongoc_client_pool_t *pool, const mongoc_server_api_t *api, bson_error_t *error)
+{
+   mongoc_topology_t *const topology = pool->topology;
+   bool ret = false;
+
+   bson_mutex_lock (&g_shared_topologies_mutex);
+   bson_mutex_lock (&topology->tpld_modification_mtx);
+
+   if (topology->scanner->api) {
+      if (!_server_api_equal (topology->scanner->api, api)) {
+         bson_set_error (error,
+                         MONGOC_ERROR_POOL,
+                         MONGOC_ERROR_POOL_API_ALREADY_SET,
+                         "Cannot set a server api different from the one used by the shared topology");
+         GOTO (done);
+      }
+   } else if (_shared_topology_monitoring_started (topology)) {
+      bson_set_error (error,
+                      MONGOC_ERROR_POOL,
+                      MONGOC_ERROR_POOL_API_TOO_LATE,
+                      "Cannot set server api after the shared topology started monitoring");
+      GOTO (done);
+   } else {
+      _mongoc_topology_scanner_set_server_api (topology->scanner, api);
+   }
+
+   ret = true;
+
+done:
+   bson_mutex_unlock (&topology->tpld_modification_mtx);
+   bson_mutex_unlock (&g_shared_topologies_mutex);
+
+   return ret;
+}
+
+bool
+mongoc_client_pool_set_server_api (mongoc_client_pool_t *pool, const mongoc_server_api_t *api, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM (pool);
    BSON_ASSERT_PARAM (api);
 
    if (pool->api) {
@@ -662,9 +1147,838 @@ mongoc_client_pool_set_server_api (mongoc_client_pool_t *pool, const mongoc_serv
       return false;
    }
 
+   if (pool->shared && !_shared_topology_set_server_api (pool, api, error)) {
+      return false;
+   }
+
    pool->api = mongoc_server_api_copy (api);
 
-   _mongoc_topology_scanner_set_server_api (pool->topology->scanner, api);
+   if (!pool->shared) {
+      _mongoc_topology_scanner_set_server_api (pool->topology->scanner, api);
+   }
+
+   return true;
+}
+
+
+/* Number of sampled _id values per worker used to pick split points. More
+ * samples give more even ranges at the cost of a larger $sample. */
+#define PARALLEL_SCAN_SAMPLES_PER_WORKER 16
+
+typedef struct {
+   int stop;
+   bson_mutex_t mutex;
+   bool failed;
+   bson_error_t error;
+} _parallel_scan_state_t;
+
+typedef struct {
+   mongoc_client_pool_t *pool;
+   const char *db;
+   const char *collection;
+   const bson_t *filter;
+   bson_t opts;
+   mongoc_client_pool_scan_cb_t cb;
+   void *ctx;
+   _parallel_scan_state_t *state;
+   bson_thread_t thread;
+   bool started;
+} _parallel_scan_worker_t;
+
+static void
+_parallel_scan_fail (_parallel_scan_state_t *state, const bson_error_t *error)
+{
+   bson_mutex_lock (&state->mutex);
+   if (!state->failed) {
+      state->failed = true;
+      memcpy (&state->error, error, sizeof (bson_error_t));
+   }
+   bson_mutex_unlock (&state->mutex);
+
+   bson_atomic_int_exchange (&state->stop, 1, bson_memory_order_relaxed);
+}
+
+static BSON_THREAD_FUN (_parallel_scan_worker, data)
+{
+   _parallel_scan_worker_t *const worker = (_parallel_scan_worker_t *) data;
+   mongoc_client_t *client;
+   mongoc_collection_t *coll;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_error_t error;
+
+   client = mongoc_client_pool_pop (worker->pool);
+   coll = mongoc_client_get_collection (client, worker->db, worker->collection);
+   cursor = mongoc_collection_find_with_opts (coll, worker->filter, &worker->opts, NULL);
+
+   while (!bson_atomic_int_fetch (&worker->state->stop, bson_memory_order_relaxed) &&
+          mongoc_cursor_next (cursor, &doc)) {
+      if (!worker->cb (doc, worker->ctx)) {
+         bson_atomic_int_exchange (&worker->state->stop, 1, bson_memory_order_relaxed);
+         break;
+      }
+   }
+
+   if (mongoc_cursor_error (cursor, &error)) {
+      _parallel_scan_fail (worker->state, &error);
+   }
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (coll);
+   mongoc_client_pool_push (worker->pool, client);
+
+   BSON_THREAD_RETURN;
+}
+
+/* Samples the collection's _id values and appends up to n_ranges - 1 distinct,
+ * ascending split points to bounds, each as a bson_t * of the form {_id: v}. */
+static bool
+_parallel_scan_split_points (mongoc_client_pool_t *pool,
+                             const char *db,
+                             const char *collection,
+                             uint32_t n_ranges,
+                             mongoc_array_t *bounds,
+                             bson_error_t *error)
+{
+   mongoc_client_t *client;
+   mongoc_collection_t *coll;
+   mongoc_cursor_t *cursor;
+   mongoc_array_t samples;
+   const bson_t *doc;
+   bson_t *pipeline;
+   bson_t *bound;
+   bson_t *prev = NULL;
+   uint32_t i;
+   bool ret;
+
+   pipeline = BCON_NEW ("pipeline",
+                        "[",
+                        "{",
+                        "$sample",
+                        "{",
+                        "size",
+                        BCON_INT64 ((int64_t) n_ranges * PARALLEL_SCAN_SAMPLES_PER_WORKER),
+                        "}",
+                        "}",
+                        "{",
+                        "$project",
+                        "{",
+                        "_id",
+                        BCON_INT32 (1),
+                        "}",
+                        "}",
+                        "{",
+                        "$sort",
+                        "{",
+                        "_id",
+                        BCON_INT32 (1),
+                        "}",
+                        "}",
+                        "]");
+
+   _mongoc_array_init (&samples, sizeof (bson_t *));
+
+   client = mongoc_client_pool_pop (pool);
+   coll = mongoc_client_get_collection (client, db, collection);
+   cursor = mongoc_collection_aggregate (coll, MONGOC_QUERY_NONE, pipeline, NULL, NULL);
+
+   while (mongoc_cursor_next (cursor, &doc)) {
+      bson_t *const copy = bson_copy (doc);
+      _mongoc_array_append_val (&samples, copy);
+   }
+
+   ret = !mongoc_cursor_error (cursor, error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (coll);
+   mongoc_client_pool_push (pool, client);
+
+   if (ret && samples.len > 0u) {
+      for (i = 1u; i < n_ranges; i++) {
+         bound = _mongoc_array_index (&samples, bson_t *, (size_t) i * samples.len / n_ranges);
+
+         /* $sample may return a document more than once */
+         if (prev && bson_equal (prev, bound)) {
+            continue;
+         }
+
+         bound = bson_copy (bound);
+         _mongoc_array_append_val (bounds, bound);
+         prev = bound;
+      }
+   }
+
+   for (i = 0u; i < samples.len; i++) {
+      bson_destroy (_mongoc_array_index (&samples, bson_t *, i));
+   }
+
+   _mongoc_array_destroy (&samples);
+   bson_destroy (pipeline);
+
+   return ret;
+}
+
+bool
+mongoc_client_pool_parallel_scan (mongoc_client_pool_t *pool,
+                                  const char *db,
+                                  const char *collection,
+                                  const bson_t *filter,
+                                  const bson_t *opts,
+                                  uint32_t max_workers,
+                                  mongoc_client_pool_scan_cb_t cb,
+                                  void *ctx,
+                                  bson_error_t *error)
+{
+   static const char *const reserved_opts[] = {"hint", "min", "max", "sort", "skip", "limit"};
+   _parallel_scan_state_t state = {0};
+   bson_t empty_filter = BSON_INITIALIZER;
+   bson_t id_index = BSON_INITIALIZER;
+   _parallel_scan_worker_t *workers;
+   mongoc_array_t bounds;
+   uint32_t n_workers;
+   uint32_t i;
+   size_t j;
+   bool ret = false;
+
+   BSON_ASSERT_PARAM (pool);
+   BSON_ASSERT_PARAM (db);
+   BSON_ASSERT_PARAM (collection);
+   BSON_ASSERT_PARAM (cb);
+
+   if (max_workers == 0u) {
+      bson_set_error (
+         error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "max_workers must be greater than zero");
+      return false;
+   }
+
+   for (j = 0u; opts && j < sizeof reserved_opts / sizeof reserved_opts[0]; j++) {
+      if (bson_has_field (opts, reserved_opts[j])) {
+         bson_set_error (error,
+                         MONGOC_ERROR_COMMAND,
+                         MONGOC_ERROR_COMMAND_INVALID_ARG,
+                         "Cannot specify \"%s\" for a parallel scan",
+                         reserved_opts[j]);
+         return false;
+      }
+   }
+
+   _mongoc_array_init (&bounds, sizeof (bson_t *));
+
+   if (!_parallel_scan_split_points (pool, db, collection, max_workers, &bounds, error)) {
+      _mongoc_array_destroy (&bounds);
+      return false;
+   }
+
+   BSON_APPEND_INT32 (&id_index, "_id", 1);
+   n_workers = bounds.len + 1u;
+   workers = bson_malloc0 (n_workers * sizeof (_parallel_scan_worker_t));
+   bson_mutex_init (&state.mutex);
+
+   /* worker i scans [bounds[i - 1], bounds[i]) in _id index order. min and max
+    * bound the index scan by the total BSON order, so _id values of any type
+    * fall into exactly one range. */
+   for (i = 0u; i < n_workers; i++) {
+      _parallel_scan_worker_t *const worker = &workers[i];
+
+      worker->pool = pool;
+      worker->db = db;
+      worker->collection = collection;
+      worker->filter = filter ? filter : &empty_filter;
+      worker->cb = cb;
+      worker->ctx = ctx;
+      worker->state = &state;
+
+      if (opts) {
+         bson_copy_to (opts, &worker->opts);
+      } else {
+         bson_init (&worker->opts);
+      }
+
+      if (n_workers > 1u) {
+         BSON_APPEND_DOCUMENT (&worker->opts, "hint", &id_index);
+         if (i > 0u) {
+            BSON_APPEND_DOCUMENT (&worker->opts, "min", _mongoc_array_index (&bounds, bson_t *, i - 1u));
+         }
+         if (i < bounds.len) {
+            BSON_APPEND_DOCUMENT (&worker->opts, "max", _mongoc_array_index (&bounds, bson_t *, i));
+         }
+      }
+   }
+
+   for (i = 0u; i < n_workers; i++) {
+      if (mcommon_thread_create (&workers[i].thread, _parallel_scan_worker, &workers[i]) != 0) {
+         bson_error_t thread_error;
+
+         bson_set_error (&thread_error,
+                         MONGOC_ERROR_CLIENT,
+                         MONGOC_ERROR_CLIENT_NOT_READY,
+                         "Failed to start a parallel scan worker thread");
+         _parallel_scan_fail (&state, &thread_error);
+         break;
+      }
+
+      workers[i].started = true;
+   }
+
+   for (i = 0u; i < n_workers; i++) {
+      if (workers[i].started) {
+         mcommon_thread_join (workers[i].thread);
+      }
+      bson_destroy (&workers[i].opts);
+   }
+
+   if (state.failed) {
+      if (error) {
+         memcpy (error, &state.error, sizeof (bson_error_t));
+      }
+   } else {
+      ret = true;
+   }
+
+   for (i = 0u; i < bounds.len; i++) {
+      bson_destroy (_mongoc_array_index (&bounds, bson_t *, i));
+   }
+
+   _mongoc_array_destroy (&bounds);
+   bson_destroy (&id_index);
+   bson_mutex_destroy (&state.mutex);
+   bson_free (workers);
+
+   return ret;
+}
+
+
+/* A caller of mongoc_client_pool_insert_one, waiting for its document to be
+ * sent with others to the same namespace. */
+typedef struct _insert_group_request_t {
+   const bson_t *document;
+   /* filled in by the caller that sends the batch, before setting done */
+   mongoc_write_result_t result;
+   bool done;
+   struct _insert_group_request_t *next;
+} _insert_group_request_t;
+
+/* Pending inserts for one namespace. At most one caller at a time, the
+ * leader, sends a batch; the inserts that arrive meanwhile form the next one. */
+typedef struct _insert_group_t {
+   char *ns;
+   bool leader_active;
+   _insert_group_request_t *head;
+   _insert_group_request_t *tail;
+   struct _insert_group_t *next;
+} _insert_group_t;
+
+static void
+_insert_groups_destroy (mongoc_client_pool_t *pool)
+{
+   _insert_group_t *group;
+   _insert_group_t *tmp;
+
+   LL_FOREACH_SAFE (pool->insert_groups, group, tmp)
+   {
+      bson_free (group->ns);
+      bson_free (group);
+   }
+
+   pool->insert_groups = NULL;
+}
+
+/* Returns the group for db.collection, creating it if needed. Called with
+ * pool->mutex held. */
+static _insert_group_t *
+_insert_group_get (mongoc_client_pool_t *pool, const char *db, const char *collection)
+{
+   _insert_group_t *group;
+   char *ns = bson_strdup_printf ("%s.%s", db, collection);
+
+   LL_FOREACH (pool->insert_groups, group)
+   {
+      if (0 == strcmp (group->ns, ns)) {
+         bson_free (ns);
+         return group;
+      }
+   }
+
+   group = BSON_ALIGNED_ALLOC0 (_insert_group_t);
+   group->ns = ns;
+   LL_PREPEND (pool->insert_groups, group);
+
+   return group;
+}
+
+/* Inserts "n" requests' documents with one unordered bulk write and splits
+ * the outcome into each request's result, as if it had been inserted alone.
+ * The documents must fit in a single insert command, so that a command or
+ * network error means none of them was inserted. */
+static void
+_insert_group_send_chunk (mongoc_collection_t *coll,
+                          const mongoc_write_concern_t *wc,
+                          _insert_group_request_t *const *requests,
+                          size_t n)
+{
+   mongoc_bulk_operation_t *bulk;
+   mongoc_array_t sent;
+   _insert_group_request_t *request;
+   bson_t opts = BSON_INITIALIZER;
+   bson_t bulk_reply;
+   bson_error_t bulk_error;
+   bson_iter_t iter;
+   bool batch_failed;
+   bool ok;
+
+   _mongoc_array_init (&sent, sizeof (_insert_group_request_t *));
+   BSON_APPEND_BOOL (&opts, "ordered", false);
+
+   bulk = mongoc_collection_create_bulk_operation_with_opts (coll, &opts);
+
+   for (size_t i = 0u; i < n; i++) {
+      request = requests[i];
+      if (mongoc_bulk_operation_insert_with_opts (bulk, request->document, NULL, &request->result.error)) {
+         _mongoc_array_append_val (&sent, request);
+      } else {
+         request->result.failed = true;
+      }
+   }
+
+   if (!sent.len) {
+      GOTO (done);
+   }
+
+   ok = mongoc_bulk_operation_execute (bulk, &bulk_reply, &bulk_error);
+
+   /* a command or network error, rather than errors in some documents */
+   batch_failed = !ok && (bulk->result.must_stop ||
+                          (bson_empty (&bulk->result.writeErrors) && !bulk->result.n_writeConcernErrors));
+
+   /* writeErrors are like [{"index": 3, "code": 11000, "errmsg": "..."}], the
+    * index being the position in the bulk */
+   if (bson_iter_init (&iter, &bulk->result.writeErrors)) {
+      while (bson_iter_next (&iter)) {
+         bson_t write_error;
+         bson_t renumbered;
+         bson_iter_t index;
+
+         const uint8_t *data;
+         uint32_t len;
+
+         if (!BSON_ITER_HOLDS_DOCUMENT (&iter)) {
+            continue;
+         }
+
+         bson_iter_document (&iter, &len, &data);
+         BSON_ASSERT (bson_init_static (&write_error, data, len));
+
+         if (!bson_iter_init_find (&index, &write_error, "index") || !BSON_ITER_HOLDS_INT (&index) ||
+             bson_iter_as_int64 (&index) < 0 || (size_t) bson_iter_as_int64 (&index) >= sent.len) {
+            continue;
+         }
+
+         request = _mongoc_array_index (&sent, _insert_group_request_t *, (size_t) bson_iter_as_int64 (&index));
+
+         /* renumber the error as the only document of the request */
+         bson_append_document_begin (&request->result.writeErrors, "0", 1, &renumbered);
+         BSON_APPEND_INT32 (&renumbered, "index", 0);
+         bson_copy_to_excluding_noinit (&write_error, &renumbered, "index", NULL);
+         bson_append_document_end (&request->result.writeErrors, &renumbered);
+
+         request->result.failed = true;
+      }
+   }
+
+   for (size_t i = 0u; i < sent.len; i++) {
+      request = _mongoc_array_index (&sent, _insert_group_request_t *, i);
 
+      bson_concat (&request->result.errorLabels, &bulk->result.errorLabels);
+      bson_concat (&request->result.writeConcernErrors, &bulk->result.writeConcernErrors);
+      request->result.n_writeConcernErrors = bulk->result.n_writeConcernErrors;
+
+      if (request->result.failed) {
+         continue;
+      }
+
+      if (batch_failed) {
+         request->result.failed = true;
+         memcpy (&request->result.error, &bulk_error, sizeof (bson_error_t));
+      } else if (mongoc_write_concern_is_acknowledged (wc)) {
+         request->result.nInserted = 1;
+      }
+   }
+
+   bson_destroy (&bulk_reply);
+
+done:
+   mongoc_bulk_operation_destroy (bulk);
+   _mongoc_array_destroy (&sent);
+   bson_destroy (&opts);
+}
+
+
+/* Inserts the batch's documents, in as many insert commands as the server's
+ * limits require. Each command is sent as its own bulk write, so a command
+ * or network error only fails the requests whose documents it carried. */
+static void
+_insert_group_send (mongoc_client_pool_t *pool,
+                    const char *db,
+                    const char *collection,
+                    _insert_group_request_t *batch)
+{
+   const mongoc_write_concern_t *wc = mongoc_uri_get_write_concern (pool->uri);
+   mongoc_client_t *client;
+   mongoc_collection_t *coll;
+   mongoc_server_description_t *sd;
+   mongoc_array_t chunk;
+   _insert_group_request_t *request;
+   bson_error_t error;
+   size_t max_documents;
+   size_t max_bytes;
+   size_t chunk_bytes = 0u;
+
+   _mongoc_array_init (&chunk, sizeof (_insert_group_request_t *));
+
+   client = mongoc_client_pool_pop (pool);
+   coll = mongoc_client_get_collection (client, db, collection);
+
+   sd = mongoc_client_select_server (client, true /* for writes */, NULL /* read prefs */, &error);
+   if (!sd) {
+      LL_FOREACH (batch, request)
+      {
+         request->result.failed = true;
+         memcpy (&request->result.error, &error, sizeof (bson_error_t));
+      }
+
+      GOTO (done);
+   }
+
+   max_documents = sd->max_write_batch_size > 0 ? (size_t) sd->max_write_batch_size : MONGOC_DEFAULT_WRITE_BATCH_SIZE;
+   /* leave room in the message for the command document, which is no larger
+    * than maxBsonObjectSize */
+   max_bytes = sd->max_msg_size > sd->max_bson_obj_size ? (size_t) (sd->max_msg_size - sd->max_bson_obj_size)
+                                                        : (size_t) MONGOC_DEFAULT_BSON_OBJ_SIZE;
+   mongoc_server_description_destroy (sd);
+
+   LL_FOREACH (batch, request)
+   {
+      if (chunk.len && (chunk.len == max_documents || chunk_bytes + request->document->len > max_bytes)) {
+         _insert_group_send_chunk (coll, wc, (_insert_group_request_t *const *) chunk.data, chunk.len);
+         chunk.len = 0u;
+         chunk_bytes = 0u;
+      }
+
+      _mongoc_array_append_val (&chunk, request);
+      chunk_bytes += request->document->len;
+   }
+
+   if (chunk.len) {
+      _insert_group_send_chunk (coll, wc, (_insert_group_request_t *const *) chunk.data, chunk.len);
+   }
+
+done:
+   mongoc_collection_destroy (coll);
+   mongoc_client_pool_push (pool, client);
+   _mongoc_array_destroy (&chunk);
+}
+
+
+bool
+mongoc_client_pool_insert_one (mongoc_client_pool_t *pool,
+                               const char *db,
+                               const char *collection,
+                               const bson_t *document,
+                               bson_t *reply,
+                               bson_error_t *error)
+{
+   _insert_group_request_t request = {0};
+   _insert_group_request_t *batch;
+   _insert_group_request_t *next;
+   _insert_group_t *group;
+   bson_t with_id = BSON_INITIALIZER;
+   bson_oid_t oid;
+   bson_iter_t iter;
+   bool ret;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM (pool);
+   BSON_ASSERT_PARAM (db);
+   BSON_ASSERT_PARAM (collection);
+   BSON_ASSERT_PARAM (document);
+
+   _mongoc_bson_init_if_set (reply);
+
+   /* generate the _id here, so it can be returned in the reply */
+   if (bson_iter_init_find (&iter, document, "_id")) {
+      request.document = document;
+   } else {
+      bson_oid_init (&oid, NULL);
+      BSON_APPEND_OID (&with_id, "_id", &oid);
+      bson_concat (&with_id, document);
+      request.document = &with_id;
+   }
+
+   _mongoc_write_result_init (&request.result);
+
+   bson_mutex_lock (&pool->mutex);
+
+   group = _insert_group_get (pool, db, collection);
+   if (group->tail) {
+      group->tail->next = &request;
+   } else {
+      group->head = &request;
+   }
+   group->tail = &request;
+
+   while (!request.done) {
+      if (group->leader_active) {
+         mongoc_cond_wait (&pool->insert_cond, &pool->mutex);
+         continue;
+      }
+
+      /* become the leader: send everything queued, including our request */
+      group->leader_active = true;
+      batch = group->head;
+      group->head = group->tail = NULL;
+      bson_mutex_unlock (&pool->mutex);
+
+      _insert_group_send (pool, db, collection, batch);
+
+      bson_mutex_lock (&pool->mutex);
+      for (; batch; batch = next) {
+         /* a follower's request is on its stack; read next before waking it */
+         next = batch->next;
+         batch->done = true;
+      }
+      group->leader_active = false;
+      mongoc_cond_broadcast (&pool->insert_cond);
+   }
+
+   bson_mutex_unlock (&pool->mutex);
+
+   ret = MONGOC_WRITE_RESULT_COMPLETE (&request.result,
+                                       pool->error_api_version,
+                                       mongoc_uri_get_write_concern (pool->uri),
+                                       /* no error domain override */
+                                       (mongoc_error_domain_t) 0,
+                                       reply,
+                                       error,
+                                       "insertedCount");
+
+   if (reply && request.result.nInserted > 0 && bson_iter_init_find (&iter, request.document, "_id")) {
+      BSON_APPEND_VALUE (reply, "insertedId", bson_iter_value (&iter));
+   }
+
+   _mongoc_write_result_destroy (&request.result);
+   bson_destroy (&with_id);
+
+   RETURN (ret);
+}
+
+
+/* Servers that may be selected for operations. Connections to others would
+ * never be used. */
+static bool
+_warm_up_server_type (mongoc_server_description_type_t type)
+{
+   switch (type) {
+   case MONGOC_SERVER_STANDALONE:
+   case MONGOC_SERVER_MONGOS:
+   case MONGOC_SERVER_RS_PRIMARY:
+   case MONGOC_SERVER_RS_SECONDARY:
+   case MONGOC_SERVER_LOAD_BALANCER:
+      return true;
+   case MONGOC_SERVER_UNKNOWN:
+   case MONGOC_SERVER_POSSIBLE_PRIMARY:
+   case MONGOC_SERVER_RS_ARBITER:
+   case MONGOC_SERVER_RS_OTHER:
+   case MONGOC_SERVER_RS_GHOST:
+   case MONGOC_SERVER_DESCRIPTION_TYPES:
+   default:
+      return false;
+   }
+}
+
+/* Connect and authenticate `client` to every selectable server it has no
+ * usable connection to. Existing connections are reused without I/O. Returns
+ * the number of selectable servers. */
+static size_t
+_warm_up_client (mongoc_client_t *client)
+{
+   mongoc_array_t server_ids;
+   mongoc_server_stream_t *server_stream;
+   bson_error_t error;
+   size_t n_servers;
+   size_t i;
+
+   _mongoc_array_init (&server_ids, sizeof (uint32_t));
+
+   {
+      mc_shared_tpld td = mc_tpld_take_ref (client->topology);
+      const mongoc_set_t *servers = mc_tpld_servers_const (td.ptr);
+
+      for (i = 0; i < servers->items_len; i++) {
+         const mongoc_server_description_t *sd = (const mongoc_server_description_t *) servers->items[i].item;
+
+         if (_warm_up_server_type (sd->type)) {
+            _mongoc_array_append_val (&server_ids, servers->items[i].id);
+         }
+      }
+      mc_tpld_drop_ref (&td);
+   }
+
+   for (i = 0; i < server_ids.len; i++) {
+      const uint32_t server_id = _mongoc_array_index (&server_ids, uint32_t, i);
+
+      server_stream = mongoc_cluster_stream_for_server (
+         &client->cluster, server_id, true /* reconnect_ok */, NULL /* session */, NULL /* reply */, &error);
+      if (!server_stream) {
+         /* The server is marked unknown as for any operation; the next round
+          * retries once it is rediscovered. */
+         MONGOC_DEBUG ("Failed to warm up connection to server %" PRIu32 ": %s", server_id, error.message);
+         continue;
+      }
+
+      mongoc_server_stream_cleanup (server_stream);
+   }
+
+   n_servers = server_ids.len;
+   _mongoc_array_destroy (&server_ids);
+
+   return n_servers;
+}
+
+static BSON_THREAD_FUN (_warm_up_thread, data)
+{
+   mongoc_client_pool_t *pool = (mongoc_client_pool_t *) data;
+   mongoc_client_t **clients = NULL;
+   uint32_t n_alloc = 0;
+   int64_t heartbeat_ms;
+   int64_t wait_ms;
+
+   heartbeat_ms = mongoc_uri_get_option_as_int32 (
+      pool->uri, MONGOC_URI_HEARTBEATFREQUENCYMS, MONGOC_TOPOLOGY_HEARTBEAT_FREQUENCY_MS_MULTI_THREADED);
+
+   bson_mutex_lock (&pool->mutex);
+   while (!pool->warm_up_shutdown) {
+      const uint32_t warm_up_size = pool->warm_up_size;
+      size_t n_servers = 0;
+      uint32_t n_clients;
+      uint32_t i;
+
+      bson_mutex_unlock (&pool->mutex);
+
+      if (warm_up_size > n_alloc) {
+         clients = bson_realloc (clients, warm_up_size * sizeof (mongoc_client_t *));
+         n_alloc = warm_up_size;
+      }
+
+      /* Check out idle clients, or create them while the pool is below its
+       * maximum size, so no other thread uses them while they connect. */
+      for (n_clients = 0; n_clients < warm_up_size; n_clients++) {
+         if (!(clients[n_clients] = mongoc_client_pool_try_pop (pool))) {
+            break;
+         }
+      }
+
+      for (i = 0; i < n_clients; i++) {
+         n_servers = _warm_up_client (clients[i]);
+      }
+
+      for (i = 0; i < n_clients; i++) {
+         mongoc_client_pool_push (pool, clients[i]);
+      }
+
+      /* Servers discovered or reconnected since are picked up next round.
+       * Until the first server is discovered, check again sooner. */
+      wait_ms = (n_clients > 0 && n_servers == 0) ? MONGOC_TOPOLOGY_MIN_HEARTBEAT_FREQUENCY_MS : heartbeat_ms;
+
+      bson_mutex_lock (&pool->mutex);
+      if (!pool->warm_up_shutdown) {
+         mongoc_cond_timedwait (&pool->warm_up_cond, &pool->mutex, wait_ms);
+      }
+   }
+   bson_mutex_unlock (&pool->mutex);
+
+   bson_free (clients);
+
+   BSON_THREAD_RETURN;
+}
+
+
+bool
+mongoc_client_pool_set_warm_up_size (mongoc_client_pool_t *pool, uint32_t warm_up_size, bson_error_t *error)
+{
+   bool ret = true;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM (pool);
+   BSON_OPTIONAL_PARAM (error);
+
+   bson_mutex_lock (&pool->mutex);
+   pool->warm_up_size = warm_up_size;
+
+   if (pool->warm_up_started) {
+      /* Apply the new size now rather than after the next heartbeat. */
+      mongoc_cond_signal (&pool->warm_up_cond);
+   } else if (pool->client_initialized) {
+      ret = _warm_up_start_if_needed (pool, error);
+   }
+   /* Otherwise the thread starts on the application's first pop, so the pool
+    * can still be configured until then. */
+   bson_mutex_unlock (&pool->mutex);
+
+   RETURN (ret);
+}
+
+
+/*
+ * Start the connection warm-up thread if a warm-up size is set.
+ *
+ * This function assumes the pool's mutex is locked
+ */
+static bool
+_warm_up_start_if_needed (mongoc_client_pool_t *pool, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM (pool);
+
+   if (pool->warm_up_size == 0 || pool->warm_up_started || pool->warm_up_shutdown) {
+      return true;
+   }
+
+   if (mcommon_thread_create (&pool->warm_up_thread, _warm_up_thread, pool) != 0) {
+      bson_set_error (
+         error, MONGOC_ERROR_CLIENT, MONGOC_ERROR_CLIENT_NOT_READY, "Failed to start the connection warm-up thread");
+      pool->warm_up_size = 0;
+      return false;
+   }
+
+   pool->warm_up_started = true;
    return true;
 }
+
+
+static void
+_warm_up_start_or_log (mongoc_client_pool_t *pool)
+{
+   bson_error_t error;
+
+   if (!_warm_up_start_if_needed (pool, &error)) {
+      MONGOC_ERROR ("%s", error.message);
+   }
+}
+
+
+static void
+_warm_up_stop (mongoc_client_pool_t *pool)
+{
+   bool started;
+
+   bson_mutex_lock (&pool->mutex);
+   started = pool->warm_up_started;
+   pool->warm_up_shutdown = true;
+   mongoc_cond_signal (&pool->warm_up_cond);
+   bson_mutex_unlock (&pool->mutex);
+
+   if (started) {
+      mcommon_thread_join (pool->warm_up_thread);
+   }
+}
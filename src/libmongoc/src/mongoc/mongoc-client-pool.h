@@ -36,11 +36,15 @@ BSON_BEGIN_DECLS
 
 typedef struct _mongoc_client_pool_t mongoc_client_pool_t;
 
+typedef bool (*mongoc_client_pool_scan_cb_t) (const bson_t *document, void *ctx);
+
 
 MONGOC_EXPORT (mongoc_client_pool_t *)
 mongoc_client_pool_new (const mongoc_uri_t *uri) BSON_GNUC_WARN_UNUSED_RESULT;
 MONGOC_EXPORT (mongoc_client_pool_t *)
 mongoc_client_pool_new_with_error (const mongoc_uri_t *uri, bson_error_t *error) BSON_GNUC_WARN_UNUSED_RESULT;
+MONGOC_EXPORT (mongoc_client_pool_t *)
+mongoc_client_pool_new_shared (const mongoc_uri_t *uri, bson_error_t *error) BSON_GNUC_WARN_UNUSED_RESULT;
 MONGOC_EXPORT (void)
 mongoc_client_pool_destroy (mongoc_client_pool_t *pool);
 MONGOC_EXPORT (mongoc_client_t *)
@@ -69,6 +73,25 @@ mongoc_client_pool_enable_auto_encryption (mongoc_client_pool_t *pool,
                                            bson_error_t *error);
 MONGOC_EXPORT (bool)
 mongoc_client_pool_set_server_api (mongoc_client_pool_t *pool, const mongoc_server_api_t *api, bson_error_t *error);
+MONGOC_EXPORT (bool)
+mongoc_client_pool_parallel_scan (mongoc_client_pool_t *pool,
+                                  const char *db,
+                                  const char *collection,
+                                  const bson_t *filter,
+                                  const bson_t *opts,
+                                  uint32_t max_workers,
+                                  mongoc_client_pool_scan_cb_t cb,
+                                  void *ctx,
+                                  bson_error_t *error);
+MONGOC_EXPORT (bool)
+mongoc_client_pool_insert_one (mongoc_client_pool_t *pool,
+                               const char *db,
+                               const char *collection,
+                               const bson_t *document,
+                               bson_t *reply,
+                               bson_error_t *error);
+MONGOC_EXPORT (bool)
+mongoc_client_pool_set_warm_up_size (mongoc_client_pool_t *pool, uint32_t warm_up_size, bson_error_t *error);
 
 BSON_END_DECLS
 
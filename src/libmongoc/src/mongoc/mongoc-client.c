@@ -64,6 +64,7 @@
 
 #ifdef MONGOC_ENABLE_SSL
 #include "mongoc-stream-tls.h"
+#include "mongoc-stream-tls-private.h"
 #include "mongoc-ssl-private.h"
 #include "mongoc-cmd-private.h"
 #include "mongoc-opts-private.h"
@@ -797,7 +798,8 @@ mongoc_client_connect (bool buffered,
       if (use_ssl || (mechanism && (0 == strcmp (mechanism, "MONGODB-X509")))) {
          mongoc_stream_t *original = base_stream;
 
-         base_stream = mongoc_stream_tls_new_with_hostname (base_stream, host->host, ssl_opts, true);
+         base_stream =
+            _mongoc_stream_tls_new_with_hostname_and_port (base_stream, host->host, host->port, ssl_opts, true);
 
          if (!base_stream) {
             mongoc_stream_destroy (original);
@@ -63,6 +63,10 @@ typedef struct _mongoc_cluster_t {
 
    mongoc_set_t *nodes;
    mongoc_array_t iov;
+
+   /* Reused to receive replies. Allocated on first use, and released after
+    * receiving a reply larger than MONGOC_CLUSTER_RECV_BUFFER_MAX_RETAINED. */
+   mongoc_buffer_t recv_buffer;
 } mongoc_cluster_t;
 
 
@@ -81,12 +85,24 @@ mongoc_cluster_reset_sockettimeoutms (mongoc_cluster_t *cluster);
 void
 mongoc_cluster_disconnect_node (mongoc_cluster_t *cluster, uint32_t id);
 
+mongoc_cluster_node_t *
+mongoc_cluster_detach_node (mongoc_cluster_t *cluster, uint32_t server_id);
+
+void
+mongoc_cluster_attach_node (mongoc_cluster_t *cluster, uint32_t server_id, mongoc_cluster_node_t *node);
+
+void
+mongoc_cluster_node_destroy (mongoc_cluster_node_t *node);
+
 int32_t
 mongoc_cluster_get_max_bson_obj_size (mongoc_cluster_t *cluster);
 
 int32_t
 mongoc_cluster_get_max_msg_size (mongoc_cluster_t *cluster);
 
+int32_t
+mongoc_cluster_get_max_write_batch_size (mongoc_cluster_t *cluster);
+
 size_t
 _mongoc_cluster_buffer_iovec (mongoc_iovec_t *iov, size_t iovcnt, int skip, char *buffer);
 
@@ -67,6 +67,11 @@
 
 #define CHECK_CLOSED_DURATION_MSEC 1000
 
+/* Initial capacity of the buffer used to receive replies: most replies,
+ * including the handshake, fit in one read. */
+#define MONGOC_CLUSTER_RECV_BUFFER_SIZE (16 * 1024)
+#define MONGOC_CLUSTER_RECV_BUFFER_MAX_RETAINED (64 * 1024)
+
 #define IS_NOT_COMMAND(_name) (!!strcasecmp (cmd->command_name, _name))
 
 static mongoc_server_stream_t *
@@ -108,6 +113,16 @@ _handle_not_primary_error (mongoc_cluster_t *cluster, const mongoc_server_stream
    }
 }
 
+static bool
+_mongoc_cluster_has_stream (mongoc_cluster_t *cluster, uint32_t server_id, const mongoc_stream_t *stream)
+{
+   mongoc_cluster_node_t *node;
+
+   node = (mongoc_cluster_node_t *) mongoc_set_get (cluster->nodes, server_id);
+
+   return node && node->stream == stream;
+}
+
 /* Called when a network error occurs on an application socket.
  */
 static void
@@ -136,8 +151,13 @@ _handle_network_error (mongoc_cluster_t *cluster, mongoc_server_stream_t *server
                                       server_stream->sd->max_wire_version,
                                       server_stream->sd->generation,
                                       &server_stream->sd->service_id);
-   /* Always disconnect the current connection on network error. */
-   mongoc_cluster_disconnect_node (cluster, server_id);
+   /* Always disconnect the current connection on network error. A
+    * connection detached from a pooled client's cluster is not in the
+    * cluster: leave the cluster's own connection alone, the detached one is
+    * closed by its owner. */
+   if (topology->single_threaded || _mongoc_cluster_has_stream (cluster, server_id, server_stream->stream)) {
+      mongoc_cluster_disconnect_node (cluster, server_id);
+   }
 
    EXIT;
 }
@@ -1849,13 +1869,103 @@ static void
 _mongoc_cluster_node_destroy (mongoc_cluster_node_t *node)
 {
    /* Failure, or Replica Set reconfigure without this node */
-   mongoc_stream_failed (node->stream);
+   if (node->stream) {
+      mongoc_stream_failed (node->stream);
+   }
    bson_free (node->connection_address);
    mongoc_server_description_destroy (node->handshake_sd);
 
    bson_free (node);
 }
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_detach_node --
+ *
+ *       Remove a pooled client's connection to a server from the cluster
+ *       without closing it. The next operation on that server opens a new
+ *       connection.
+ *
+ * Returns:
+ *       The connection, owned by the caller, or NULL if there is no
+ *       connection to the server. Give it back with
+ *       mongoc_cluster_attach_node or free it with
+ *       mongoc_cluster_node_destroy.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_cluster_node_t *
+mongoc_cluster_detach_node (mongoc_cluster_t *cluster, uint32_t server_id)
+{
+   mongoc_cluster_node_t *node;
+   mongoc_cluster_node_t *detached;
+
+   BSON_ASSERT (!cluster->client->topology->single_threaded);
+
+   node = (mongoc_cluster_node_t *) mongoc_set_get (cluster->nodes, server_id);
+   if (!node) {
+      return NULL;
+   }
+
+   /* the set destroys its item, so move the connection to a new node */
+   detached = (mongoc_cluster_node_t *) bson_malloc0 (sizeof *detached);
+   *detached = *node;
+   node->stream = NULL;
+   node->connection_address = NULL;
+   node->handshake_sd = NULL;
+   mongoc_set_rm (cluster->nodes, server_id);
+
+   return detached;
+}
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_attach_node --
+ *
+ *       Give a connection taken with mongoc_cluster_detach_node back to
+ *       the cluster, so the next operation on that server reuses it. The
+ *       caller must have read every reply the server sent on it.
+ *
+ *       If the cluster opened another connection to the server meanwhile,
+ *       or the server was removed from the topology, the connection is
+ *       closed instead. A connection from a cleared pool is replaced on
+ *       next use like any other stale connection.
+ *
+ * Side effects:
+ *       Takes ownership of @node.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+mongoc_cluster_attach_node (mongoc_cluster_t *cluster, uint32_t server_id, mongoc_cluster_node_t *node)
+{
+   mc_shared_tpld td;
+
+   BSON_ASSERT_PARAM (node);
+   BSON_ASSERT (!cluster->client->topology->single_threaded);
+
+   td = mc_tpld_take_ref (cluster->client->topology);
+   if (mongoc_set_get (cluster->nodes, server_id) ||
+       !mongoc_topology_description_server_by_id_const (td.ptr, server_id, NULL)) {
+      _mongoc_cluster_node_destroy (node);
+   } else {
+      mongoc_set_add (cluster->nodes, server_id, node);
+   }
+   mc_tpld_drop_ref (&td);
+}
+
+void
+mongoc_cluster_node_destroy (mongoc_cluster_node_t *node)
+{
+   if (node) {
+      _mongoc_cluster_node_destroy (node);
+   }
+}
+
 static void
 _mongoc_cluster_node_dtor (void *data_, void *ctx_)
 {
@@ -2556,6 +2666,10 @@ mongoc_cluster_destroy (mongoc_cluster_t *cluster) /* INOUT */
 
    _mongoc_array_destroy (&cluster->iov);
 
+   if (cluster->recv_buffer.data) {
+      _mongoc_buffer_destroy (&cluster->recv_buffer);
+   }
+
    EXIT;
 }
 
@@ -2904,6 +3018,70 @@ mongoc_cluster_get_max_msg_size (mongoc_cluster_t *cluster)
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_cluster_get_max_write_batch_size --
+ *
+ *      Return the minimum max write batch size across all known servers in
+ *      cluster, or MONGOC_DEFAULT_WRITE_BATCH_SIZE if no server has been
+ *      discovered yet.
+ *
+ * Returns:
+ *      The minimum max_write_batch_size
+ *
+ * Side effects:
+ *      None
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static bool
+_mongoc_cluster_min_of_max_write_batch_size_sds (const void *item, void *ctx)
+{
+   const mongoc_server_description_t *sd = item;
+   int32_t *current_min = (int32_t *) ctx;
+
+   if (sd->type != MONGOC_SERVER_UNKNOWN && sd->max_write_batch_size < *current_min) {
+      *current_min = sd->max_write_batch_size;
+   }
+   return true;
+}
+
+static bool
+_mongoc_cluster_min_of_max_write_batch_size_nodes (void *item, void *ctx)
+{
+   mongoc_cluster_node_t *node = (mongoc_cluster_node_t *) item;
+   int32_t *current_min = (int32_t *) ctx;
+
+   if (node->handshake_sd->max_write_batch_size < *current_min) {
+      *current_min = node->handshake_sd->max_write_batch_size;
+   }
+   return true;
+}
+
+int32_t
+mongoc_cluster_get_max_write_batch_size (mongoc_cluster_t *cluster)
+{
+   int32_t max_write_batch_size = INT32_MAX;
+
+   if (!cluster->client->topology->single_threaded) {
+      mongoc_set_for_each (cluster->nodes, _mongoc_cluster_min_of_max_write_batch_size_nodes, &max_write_batch_size);
+   } else {
+      mc_shared_tpld td = mc_tpld_take_ref (BSON_ASSERT_PTR_INLINE (cluster)->client->topology);
+      mongoc_set_for_each_const (
+         mc_tpld_servers_const (td.ptr), _mongoc_cluster_min_of_max_write_batch_size_sds, &max_write_batch_size);
+      mc_tpld_drop_ref (&td);
+   }
+
+   if (max_write_batch_size == INT32_MAX || max_write_batch_size <= 0) {
+      max_write_batch_size = MONGOC_DEFAULT_WRITE_BATCH_SIZE;
+   }
+
+   return max_write_batch_size;
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -3323,11 +3501,28 @@ _mongoc_cluster_run_opmsg_recv (
 
    mongoc_server_stream_t *const server_stream = cmd->server_stream;
 
-   mongoc_buffer_t buffer;
-   _mongoc_buffer_init (&buffer, NULL, 0, NULL, NULL);
+   mongoc_buffer_t *const buffer = &cluster->recv_buffer;
+   void *decompressed_data = NULL;
+   size_t decompressed_data_len = 0u;
+   bool read_ok;
 
-   if (!_mongoc_buffer_append_from_stream (
-          &buffer, server_stream->stream, sizeof (int32_t), cluster->sockettimeoutms, error)) {
+   if (!buffer->data) {
+      _mongoc_buffer_init (buffer, NULL, MONGOC_CLUSTER_RECV_BUFFER_SIZE, NULL, NULL);
+   }
+   _mongoc_buffer_clear (buffer, false);
+
+   if (cmd->op_msg_is_exhaust) {
+      /* The server may stream further messages right after this one. */
+      read_ok = _mongoc_buffer_append_from_stream (
+         buffer, server_stream->stream, sizeof (int32_t), cluster->sockettimeoutms, error);
+   } else {
+      /* The server sends exactly one reply, so read the length along with as
+       * much of the reply as is available: small replies need a single read. */
+      read_ok = _mongoc_buffer_append_at_least_from_stream (
+         buffer, server_stream->stream, sizeof (int32_t), cluster->sockettimeoutms, error);
+   }
+
+   if (!read_ok) {
       MONGOC_DEBUG ("could not read message length, stream probably closed or timed out");
       RUN_CMD_ERR_DECORATE;
       _handle_network_error (cluster, server_stream, error);
@@ -3336,7 +3531,7 @@ _mongoc_cluster_run_opmsg_recv (
       goto done;
    }
 
-   const int32_t message_length = _int32_from_le (buffer.data);
+   const int32_t message_length = _int32_from_le (buffer->data);
 
    if (message_length < message_header_length || message_length > server_stream->sd->max_msg_size) {
       RUN_CMD_ERR (MONGOC_ERROR_PROTOCOL,
@@ -3351,10 +3546,23 @@ _mongoc_cluster_run_opmsg_recv (
       goto done;
    }
 
-   const size_t remaining_bytes = (size_t) message_length - sizeof (int32_t);
+   if (buffer->len > (size_t) message_length) {
+      RUN_CMD_ERR (MONGOC_ERROR_PROTOCOL,
+                   MONGOC_ERROR_PROTOCOL_INVALID_REPLY,
+                   "received %zu bytes for a message of %" PRId32 " bytes",
+                   buffer->len,
+                   message_length);
+      _handle_network_error (cluster, server_stream, error);
+      server_stream->stream = NULL;
+      network_error_reply (reply, cmd);
+      goto done;
+   }
 
-   if (!_mongoc_buffer_append_from_stream (
-          &buffer, server_stream->stream, remaining_bytes, cluster->sockettimeoutms, error)) {
+   const size_t remaining_bytes = (size_t) message_length - buffer->len;
+
+   if (remaining_bytes > 0u &&
+       !_mongoc_buffer_append_from_stream (
+          buffer, server_stream->stream, remaining_bytes, cluster->sockettimeoutms, error)) {
       RUN_CMD_ERR_DECORATE;
       _handle_network_error (cluster, server_stream, error);
       server_stream->stream = NULL;
@@ -3362,7 +3570,7 @@ _mongoc_cluster_run_opmsg_recv (
       goto done;
    }
 
-   if (!mcd_rpc_message_from_data_in_place (rpc, buffer.data, buffer.len, NULL)) {
+   if (!mcd_rpc_message_from_data_in_place (rpc, buffer->data, buffer->len, NULL)) {
       RUN_CMD_ERR (MONGOC_ERROR_PROTOCOL, MONGOC_ERROR_PROTOCOL_INVALID_REPLY, "malformed server message");
       _handle_network_error (cluster, server_stream, error);
       server_stream->stream = NULL;
@@ -3371,9 +3579,6 @@ _mongoc_cluster_run_opmsg_recv (
    }
    mcd_rpc_message_ingress (rpc);
 
-   void *decompressed_data = NULL;
-   size_t decompressed_data_len = 0u;
-
    if (!mcd_rpc_message_decompress_if_necessary (rpc, &decompressed_data, &decompressed_data_len)) {
       bson_set_error (
          error, MONGOC_ERROR_PROTOCOL, MONGOC_ERROR_PROTOCOL_INVALID_REPLY, "could not decompress message from server");
@@ -3383,15 +3588,18 @@ _mongoc_cluster_run_opmsg_recv (
       GOTO (done);
    }
 
-   if (decompressed_data) {
-      _mongoc_buffer_destroy (&buffer);
-      _mongoc_buffer_init (&buffer, decompressed_data, decompressed_data_len, NULL, NULL);
-   }
-
    bson_t body;
 
    uint32_t op_msg_flags = mcd_rpc_op_msg_get_flag_bits (rpc);
-   cluster->client->in_exhaust = op_msg_flags & MONGOC_OP_MSG_FLAG_MORE_TO_COME;
+   server_stream->more_to_come = op_msg_flags & MONGOC_OP_MSG_FLAG_MORE_TO_COME;
+
+   /* A single-threaded client shares its connection with the topology scanner,
+    * so the whole client waits until the exhaust cursor is done. A pooled
+    * client's cursor takes the connection out of the cluster instead. See
+    * mongoc_cluster_detach_node. */
+   if (cluster->client->topology->single_threaded) {
+      cluster->client->in_exhaust = server_stream->more_to_come;
+   }
 
    if (!mcd_rpc_message_get_body (rpc, &body)) {
       RUN_CMD_ERR (MONGOC_ERROR_PROTOCOL, MONGOC_ERROR_PROTOCOL_INVALID_REPLY, "malformed message from server");
@@ -3413,7 +3621,12 @@ _mongoc_cluster_run_opmsg_recv (
    bson_destroy (&body);
 
 done:
-   _mongoc_buffer_destroy (&buffer);
+   bson_free (decompressed_data);
+
+   if (buffer->datalen > MONGOC_CLUSTER_RECV_BUFFER_MAX_RETAINED) {
+      /* Do not hold on to memory for occasional large replies. */
+      _mongoc_buffer_destroy (buffer);
+   }
 
    return ret;
 }
@@ -3445,7 +3658,9 @@ mongoc_cluster_run_opmsg (mongoc_cluster_t *cluster, const mongoc_cmd_t *cmd, bs
 
    mcd_rpc_message *const rpc = mcd_rpc_message_new ();
 
-   if (!cluster->client->in_exhaust && !_mongoc_cluster_run_opmsg_send (cluster, cmd, rpc, reply, error)) {
+   /* when the server has more to come, just read its next reply */
+   if (!cluster->client->in_exhaust && !cmd->server_stream->more_to_come &&
+       !_mongoc_cluster_run_opmsg_send (cluster, cmd, rpc, reply, error)) {
       goto done;
    }
 
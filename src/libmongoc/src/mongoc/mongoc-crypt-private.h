@@ -163,5 +163,18 @@ _mongoc_crypt_rewrap_many_datakey (_mongoc_crypt_t *crypt,
 const char *
 _mongoc_crypt_get_crypt_shared_version (const _mongoc_crypt_t *crypt);
 
+/* For tests: the number of idle KMS connections kept for reuse. */
+size_t
+_mongoc_crypt_idle_kms_stream_count (_mongoc_crypt_t *crypt);
+
+/* For tests: keep @stream as an idle connection to @endpoint, made with the
+ * TLS options of the KMS provider named @kms_provider. Takes ownership of
+ * @stream. */
+void
+_mongoc_crypt_add_idle_kms_stream (_mongoc_crypt_t *crypt,
+                                   const char *kms_provider,
+                                   const char *endpoint,
+                                   mongoc_stream_t *stream);
+
 #endif /* MONGOC_ENABLE_CLIENT_SIDE_ENCRYPTION */
 #endif /* MONGOC_CRYPT_PRIVATE_H */
@@ -26,10 +26,12 @@
 #include "mongoc-collection-private.h"
 #include "mongoc-host-list-private.h"
 #include "mongoc-stream-private.h"
+#include "mongoc-stream-tls-private.h"
 #include "mongoc-ssl-private.h"
 #include "mongoc-cluster-aws-private.h"
 #include "mongoc-util-private.h"
 #include "mongoc-http-private.h"
+#include "mongoc-thread-private.h"
 #include "mcd-azure.h"
 #include "mcd-time.h"
 #include "service-gcp.h"
@@ -127,8 +129,23 @@ struct __mongoc_crypt_t {
    mcd_azure_access_token azure_token;
    /// The time point at which the `azure_token` was acquired.
    mcd_time_point azure_token_issued_at;
+
+   /// Idle connections to KMS servers, kept open for later KMS requests. An
+   /// array of `_kms_stream_t`, guarded by `kms_streams_mutex` since a client
+   /// pool shares one `_mongoc_crypt_t` between threads.
+   mongoc_array_t kms_streams;
+   bson_mutex_t kms_streams_mutex;
 };
 
+/* At most this many idle KMS connections are kept. */
+#define MONGOC_CRYPT_MAX_IDLE_KMS_STREAMS 16
+
+typedef struct {
+   char *endpoint;
+   const mongoc_ssl_opt_t *ssl_opt;
+   mongoc_stream_t *stream;
+} _kms_stream_t;
+
 static void
 _log_callback (mongocrypt_log_level_t mongocrypt_log_level, const char *message, uint32_t message_len, void *ctx)
 {
@@ -504,7 +521,8 @@ _get_stream (const char *endpoint, int32_t connecttimeoutms, const mongoc_ssl_op
 
    /* Wrap in a tls_stream. */
    _mongoc_ssl_opts_copy_to (ssl_opt, &ssl_opt_copy, true /* copy_internal */);
-   tls_stream = mongoc_stream_tls_new_with_hostname (base_stream, host.host, &ssl_opt_copy, 1 /* client */);
+   tls_stream = _mongoc_stream_tls_new_with_hostname_and_port (
+      base_stream, host.host, host.port, &ssl_opt_copy, 1 /* client */);
 
    if (!tls_stream) {
       bson_set_error (
@@ -531,108 +549,254 @@ fail:
    return tls_stream;
 }
 
-static bool
-_state_need_kms (_state_machine_t *state_machine, bson_error_t *error)
+/* Take an idle connection to @endpoint made with @ssl_opt, or return NULL.
+ * Connections the server has closed meanwhile are discarded. */
+static mongoc_stream_t *
+_kms_stream_checkout (_mongoc_crypt_t *crypt, const char *endpoint, const mongoc_ssl_opt_t *ssl_opt)
 {
-   mongocrypt_kms_ctx_t *kms_ctx = NULL;
-   mongoc_stream_t *tls_stream = NULL;
-   bool ret = false;
-   mongocrypt_binary_t *http_req = NULL;
-   mongocrypt_binary_t *http_reply = NULL;
-   const char *endpoint;
-   const int32_t sockettimeout = MONGOC_DEFAULT_SOCKETTIMEOUTMS;
-   kms_ctx = mongocrypt_ctx_next_kms_ctx (state_machine->ctx);
-   while (kms_ctx) {
-      mongoc_iovec_t iov;
-      const mongoc_ssl_opt_t *ssl_opt;
-      const char *provider;
-
-      provider = mongocrypt_kms_ctx_get_kms_provider (kms_ctx, NULL);
-
-      if (0 == strcmp ("kmip", provider)) {
-         ssl_opt = &state_machine->crypt->kmip_tls_opt;
-      } else if (0 == strcmp ("aws", provider)) {
-         ssl_opt = &state_machine->crypt->aws_tls_opt;
-      } else if (0 == strcmp ("azure", provider)) {
-         ssl_opt = &state_machine->crypt->azure_tls_opt;
-      } else if (0 == strcmp ("gcp", provider)) {
-         ssl_opt = &state_machine->crypt->gcp_tls_opt;
-      } else if (mcd_mapof_kmsid_to_tlsopts_has (state_machine->crypt->kmsid_to_tlsopts, provider)) {
-         ssl_opt = mcd_mapof_kmsid_to_tlsopts_get (state_machine->crypt->kmsid_to_tlsopts, provider);
-      } else {
-         ssl_opt = mongoc_ssl_opt_get_default ();
-      }
+   mongoc_stream_t *stream = NULL;
+   size_t i = 0;
 
-      mongocrypt_binary_destroy (http_req);
-      http_req = mongocrypt_binary_new ();
-      if (!mongocrypt_kms_ctx_message (kms_ctx, http_req)) {
-         _kms_ctx_check_error (kms_ctx, error, true);
-         goto fail;
+   bson_mutex_lock (&crypt->kms_streams_mutex);
+   while (!stream && i < crypt->kms_streams.len) {
+      _kms_stream_t *entry = &_mongoc_array_index (&crypt->kms_streams, _kms_stream_t, i);
+      _kms_stream_t *last = &_mongoc_array_index (&crypt->kms_streams, _kms_stream_t, crypt->kms_streams.len - 1);
+
+      if (entry->ssl_opt != ssl_opt || 0 != strcmp (entry->endpoint, endpoint)) {
+         i++;
+         continue;
       }
 
-      if (!mongocrypt_kms_ctx_endpoint (kms_ctx, &endpoint)) {
-         _kms_ctx_check_error (kms_ctx, error, true);
-         goto fail;
+      if (mongoc_stream_check_closed (entry->stream)) {
+         mongoc_stream_destroy (entry->stream);
+      } else {
+         stream = entry->stream;
       }
 
-      mongoc_stream_destroy (tls_stream);
-      tls_stream = _get_stream (endpoint, sockettimeout, ssl_opt, error);
+      /* remove the entry by moving the last one into its place */
+      bson_free (entry->endpoint);
+      *entry = *last;
+      crypt->kms_streams.len--;
+   }
+   bson_mutex_unlock (&crypt->kms_streams_mutex);
+
+   return stream;
+}
+
+/* Keep @stream open for a later request to @endpoint. Takes ownership of
+ * @stream. */
+static void
+_kms_stream_checkin (_mongoc_crypt_t *crypt,
+                     const char *endpoint,
+                     const mongoc_ssl_opt_t *ssl_opt,
+                     mongoc_stream_t *stream)
+{
+   bson_mutex_lock (&crypt->kms_streams_mutex);
+   if (crypt->kms_streams.len < MONGOC_CRYPT_MAX_IDLE_KMS_STREAMS) {
+      _kms_stream_t entry = {.endpoint = bson_strdup (endpoint), .ssl_opt = ssl_opt, .stream = stream};
+      _mongoc_array_append_val (&crypt->kms_streams, entry);
+      stream = NULL;
+   }
+   bson_mutex_unlock (&crypt->kms_streams_mutex);
+
+   mongoc_stream_destroy (stream);
+}
+
+static void
+_kms_streams_destroy (_mongoc_crypt_t *crypt)
+{
+   for (size_t i = 0; i < crypt->kms_streams.len; i++) {
+      _kms_stream_t *entry = &_mongoc_array_index (&crypt->kms_streams, _kms_stream_t, i);
+      bson_free (entry->endpoint);
+      mongoc_stream_destroy (entry->stream);
+   }
+   _mongoc_array_destroy (&crypt->kms_streams);
+}
+
+/* A KMS request in flight, and the connection its reply arrives on. */
+typedef struct {
+   mongocrypt_kms_ctx_t *kms_ctx;
+   const char *endpoint;
+   const mongoc_ssl_opt_t *ssl_opt;
+   mongoc_stream_t *stream;
+   /* true if the stream was reused from an earlier request */
+   bool reused;
+} _kms_request_t;
+
+static const mongoc_ssl_opt_t *
+_kms_ssl_opt (_mongoc_crypt_t *crypt, const char *provider)
+{
+   if (0 == strcmp ("kmip", provider)) {
+      return &crypt->kmip_tls_opt;
+   } else if (0 == strcmp ("aws", provider)) {
+      return &crypt->aws_tls_opt;
+   } else if (0 == strcmp ("azure", provider)) {
+      return &crypt->azure_tls_opt;
+   } else if (0 == strcmp ("gcp", provider)) {
+      return &crypt->gcp_tls_opt;
+   } else if (mcd_mapof_kmsid_to_tlsopts_has (crypt->kmsid_to_tlsopts, provider)) {
+      return mcd_mapof_kmsid_to_tlsopts_get (crypt->kmsid_to_tlsopts, provider);
+   } else {
+      return mongoc_ssl_opt_get_default ();
+   }
+}
+
+/* Send the HTTP request of @req, on an idle connection to its endpoint if
+ * @reuse is true and there is one, otherwise on a new connection. */
+static bool
+_kms_request_send (_mongoc_crypt_t *crypt, _kms_request_t *req, bool reuse, bson_error_t *error)
+{
+   const int32_t sockettimeout = MONGOC_DEFAULT_SOCKETTIMEOUTMS;
+   mongocrypt_binary_t *http_req;
+   mongoc_iovec_t iov;
+   bool ret = false;
+
+   http_req = mongocrypt_binary_new ();
+   if (!mongocrypt_kms_ctx_message (req->kms_ctx, http_req)) {
+      _kms_ctx_check_error (req->kms_ctx, error, true);
+      goto fail;
+   }
+
+   mongoc_stream_destroy (req->stream);
+   req->stream = reuse ? _kms_stream_checkout (crypt, req->endpoint, req->ssl_opt) : NULL;
+   req->reused = req->stream != NULL;
+
+   if (!req->stream) {
+      req->stream = _get_stream (req->endpoint, sockettimeout, req->ssl_opt, error);
 #ifdef MONGOC_ENABLE_SSL_SECURE_CHANNEL
       /* Retry once with schannel as a workaround for CDRIVER-3566. */
-      if (!tls_stream) {
-         tls_stream = _get_stream (endpoint, sockettimeout, ssl_opt, error);
+      if (!req->stream) {
+         req->stream = _get_stream (req->endpoint, sockettimeout, req->ssl_opt, error);
       }
 #endif
-      if (!tls_stream) {
+      if (!req->stream) {
          goto fail;
       }
+   }
+
+   iov.iov_base = (char *) mongocrypt_binary_data (http_req);
+   iov.iov_len = mongocrypt_binary_len (http_req);
+
+   if (!_mongoc_stream_writev_full (req->stream, &iov, 1, sockettimeout, error)) {
+      goto fail;
+   }
+
+   ret = true;
+fail:
+   mongocrypt_binary_destroy (http_req);
+   return ret;
+}
+
+/* Read the reply to @req and feed it to its KMS context. */
+static bool
+_kms_request_recv (_kms_request_t *req, bool *nothing_read, bson_error_t *error)
+{
+#define BUFFER_SIZE 1024
+   const int32_t sockettimeout = MONGOC_DEFAULT_SOCKETTIMEOUTMS;
+   uint8_t buf[BUFFER_SIZE];
+
+   *nothing_read = true;
+
+   while (mongocrypt_kms_ctx_bytes_needed (req->kms_ctx) > 0) {
+      uint32_t bytes_needed = mongocrypt_kms_ctx_bytes_needed (req->kms_ctx);
+      mongocrypt_binary_t *http_reply;
+      ssize_t read_ret;
+      bool fed;
+
+      /* Cap the bytes requested at the buffer size. */
+      if (bytes_needed > BUFFER_SIZE) {
+         bytes_needed = BUFFER_SIZE;
+      }
+
+      read_ret = mongoc_stream_read (req->stream, buf, bytes_needed, 1 /* min_bytes. */, sockettimeout);
+      if (read_ret == -1) {
+         bson_set_error (
+            error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_SOCKET, "failed to read from KMS stream: %d", errno);
+         return false;
+      }
+
+      if (read_ret == 0) {
+         bson_set_error (error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_SOCKET, "unexpected EOF from KMS stream");
+         return false;
+      }
+
+      *nothing_read = false;
+
+      BSON_ASSERT (bson_in_range_signed (uint32_t, read_ret));
+      http_reply = mongocrypt_binary_new_from_data (buf, (uint32_t) read_ret);
+      fed = mongocrypt_kms_ctx_feed (req->kms_ctx, http_reply);
+      mongocrypt_binary_destroy (http_reply);
+      if (!fed) {
+         _kms_ctx_check_error (req->kms_ctx, error, true);
+         return false;
+      }
+   }
+
+   return true;
+#undef BUFFER_SIZE
+}
+
+/* Send all KMS requests before reading any reply, so the KMS servers process
+ * them concurrently. Connections are kept open afterward and reused by later
+ * requests to the same endpoint. */
+static bool
+_state_need_kms (_state_machine_t *state_machine, bson_error_t *error)
+{
+   _mongoc_crypt_t *crypt = state_machine->crypt;
+   mongocrypt_kms_ctx_t *kms_ctx;
+   mongoc_array_t reqs;
+   bool ret = false;
+   size_t i;
 
-      iov.iov_base = (char *) mongocrypt_binary_data (http_req);
-      iov.iov_len = mongocrypt_binary_len (http_req);
+   _mongoc_array_init (&reqs, sizeof (_kms_request_t));
 
-      if (!_mongoc_stream_writev_full (tls_stream, &iov, 1, sockettimeout, error)) {
+   while ((kms_ctx = mongocrypt_ctx_next_kms_ctx (state_machine->ctx))) {
+      const char *provider = mongocrypt_kms_ctx_get_kms_provider (kms_ctx, NULL);
+      _kms_request_t req = {.kms_ctx = kms_ctx, .ssl_opt = _kms_ssl_opt (crypt, provider)};
+
+      if (!mongocrypt_kms_ctx_endpoint (kms_ctx, &req.endpoint)) {
+         _kms_ctx_check_error (kms_ctx, error, true);
          goto fail;
       }
 
-      /* Read and feed reply. */
-      while (mongocrypt_kms_ctx_bytes_needed (kms_ctx) > 0) {
-#define BUFFER_SIZE 1024
-         uint8_t buf[BUFFER_SIZE];
-         uint32_t bytes_needed = mongocrypt_kms_ctx_bytes_needed (kms_ctx);
-         ssize_t read_ret;
+      _mongoc_array_append_val (&reqs, req);
+   }
+   /* When NULL is returned by mongocrypt_ctx_next_kms_ctx, this can either be
+    * an error or end-of-list. */
+   if (!_ctx_check_error (state_machine->ctx, error, false)) {
+      goto fail;
+   }
 
-         /* Cap the bytes requested at the buffer size. */
-         if (bytes_needed > BUFFER_SIZE) {
-            bytes_needed = BUFFER_SIZE;
-         }
+   for (i = 0; i < reqs.len; i++) {
+      _kms_request_t *req = &_mongoc_array_index (&reqs, _kms_request_t, i);
 
-         read_ret = mongoc_stream_read (tls_stream, buf, bytes_needed, 1 /* min_bytes. */, sockettimeout);
-         if (read_ret == -1) {
-            bson_set_error (
-               error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_SOCKET, "failed to read from KMS stream: %d", errno);
+      if (!_kms_request_send (crypt, req, true /* reuse */, error)) {
+         /* the server may have closed an idle connection. retry once. */
+         if (!req->reused || !_kms_request_send (crypt, req, false /* reuse */, error)) {
             goto fail;
          }
+      }
+   }
 
-         if (read_ret == 0) {
-            bson_set_error (error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_SOCKET, "unexpected EOF from KMS stream");
+   for (i = 0; i < reqs.len; i++) {
+      _kms_request_t *req = &_mongoc_array_index (&reqs, _kms_request_t, i);
+      bool nothing_read;
+
+      if (!_kms_request_recv (req, &nothing_read, error)) {
+         if (!req->reused || !nothing_read) {
             goto fail;
          }
 
-         mongocrypt_binary_destroy (http_reply);
-
-         BSON_ASSERT (bson_in_range_signed (uint32_t, read_ret));
-         http_reply = mongocrypt_binary_new_from_data (buf, (uint32_t) read_ret);
-         if (!mongocrypt_kms_ctx_feed (kms_ctx, http_reply)) {
-            _kms_ctx_check_error (kms_ctx, error, true);
+         /* the server closed an idle connection before replying. retry once
+          * on a new connection. */
+         if (!_kms_request_send (crypt, req, false /* reuse */, error) ||
+             !_kms_request_recv (req, &nothing_read, error)) {
             goto fail;
          }
       }
-      kms_ctx = mongocrypt_ctx_next_kms_ctx (state_machine->ctx);
-   }
-   /* When NULL is returned by mongocrypt_ctx_next_kms_ctx, this can either be
-    * an error or end-of-list. */
-   if (!_ctx_check_error (state_machine->ctx, error, false)) {
-      goto fail;
+
+      _kms_stream_checkin (crypt, req->endpoint, req->ssl_opt, req->stream);
+      req->stream = NULL;
    }
 
    if (!mongocrypt_ctx_kms_done (state_machine->ctx)) {
@@ -642,11 +806,11 @@ _state_need_kms (_state_machine_t *state_machine, bson_error_t *error)
 
    ret = true;
 fail:
-   mongoc_stream_destroy (tls_stream);
-   mongocrypt_binary_destroy (http_req);
-   mongocrypt_binary_destroy (http_reply);
+   for (i = 0; i < reqs.len; i++) {
+      mongoc_stream_destroy (_mongoc_array_index (&reqs, _kms_request_t, i).stream);
+   }
+   _mongoc_array_destroy (&reqs);
    return ret;
-#undef BUFFER_SIZE
 }
 
 /**
@@ -1365,6 +1529,8 @@ _mongoc_crypt_new (const bson_t *kms_providers,
    crypt = bson_malloc0 (sizeof (*crypt));
    crypt->kmsid_to_tlsopts = mcd_mapof_kmsid_to_tlsopts_new ();
    crypt->handle = mongocrypt_new ();
+   _mongoc_array_init (&crypt->kms_streams, sizeof (_kms_stream_t));
+   bson_mutex_init (&crypt->kms_streams_mutex);
 
    // Stash away a copy of the user's kmsProviders in case we need to lazily
    // load credentials.
@@ -1481,6 +1647,8 @@ _mongoc_crypt_destroy (_mongoc_crypt_t *crypt)
    bson_destroy (&crypt->kms_providers);
    mcd_azure_access_token_destroy (&crypt->azure_token);
    mcd_mapof_kmsid_to_tlsopts_destroy (crypt->kmsid_to_tlsopts);
+   _kms_streams_destroy (crypt);
+   bson_mutex_destroy (&crypt->kms_streams_mutex);
    bson_free (crypt);
 }
 
@@ -2068,6 +2236,34 @@ _mongoc_crypt_get_crypt_shared_version (const _mongoc_crypt_t *crypt)
    return mongocrypt_crypt_shared_lib_version_string (crypt->handle, NULL);
 }
 
+size_t
+_mongoc_crypt_idle_kms_stream_count (_mongoc_crypt_t *crypt)
+{
+   size_t count;
+
+   BSON_ASSERT_PARAM (crypt);
+
+   bson_mutex_lock (&crypt->kms_streams_mutex);
+   count = crypt->kms_streams.len;
+   bson_mutex_unlock (&crypt->kms_streams_mutex);
+
+   return count;
+}
+
+void
+_mongoc_crypt_add_idle_kms_stream (_mongoc_crypt_t *crypt,
+                                   const char *kms_provider,
+                                   const char *endpoint,
+                                   mongoc_stream_t *stream)
+{
+   BSON_ASSERT_PARAM (crypt);
+   BSON_ASSERT_PARAM (kms_provider);
+   BSON_ASSERT_PARAM (endpoint);
+   BSON_ASSERT_PARAM (stream);
+
+   _kms_stream_checkin (crypt, endpoint, _kms_ssl_opt (crypt, kms_provider), stream);
+}
+
 #else
 /* ensure the translation unit is not empty */
 extern int no_mongoc_client_side_encryption;
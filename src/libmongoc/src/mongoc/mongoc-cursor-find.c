@@ -98,3 +98,23 @@ _mongoc_cursor_find_new (mongoc_client_t *client,
    cursor->impl.data = data;
    return cursor;
 }
+
+
+/* create a find cursor from a cursor whose opts were already validated, by
+ * copying its state and only replacing the filter. */
+mongoc_cursor_t *
+_mongoc_cursor_find_new_from_prepared (const mongoc_cursor_t *prepared, const bson_t *filter)
+{
+   mongoc_cursor_t *cursor;
+   data_find_t *data;
+
+   BSON_ASSERT_PARAM (prepared);
+   BSON_ASSERT (prepared->impl.prime == _prime);
+
+   cursor = mongoc_cursor_clone (prepared);
+   cursor->server_id = prepared->server_id;
+   data = (data_find_t *) cursor->impl.data;
+   bson_destroy (&data->filter);
+   _mongoc_cursor_check_and_copy_to (cursor, "filter", filter, &data->filter);
+   return cursor;
+}
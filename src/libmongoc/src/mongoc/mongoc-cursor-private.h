@@ -124,6 +124,10 @@ struct _mongoc_cursor_t {
 
    mongoc_cursor_state_t state;
    bool in_exhaust;
+   /* A pooled client's exhaust cursor owns the connection the server streams
+    * replies on, so the client can run other operations meanwhile. */
+   mongoc_server_stream_t *exhaust_server_stream;
+   mongoc_cluster_node_t *exhaust_node;
 
    bson_t opts;
 
@@ -258,6 +262,9 @@ _mongoc_cursor_find_new (mongoc_client_t *client,
                          const mongoc_read_prefs_t *default_prefs,
                          const mongoc_read_concern_t *read_concern);
 
+mongoc_cursor_t *
+_mongoc_cursor_find_new_from_prepared (const mongoc_cursor_t *prepared, const bson_t *filter);
+
 mongoc_cursor_t *
 _mongoc_cursor_cmd_new (mongoc_client_t *client,
                         const char *db_and_coll,
@@ -536,10 +536,21 @@ mongoc_cursor_destroy (mongoc_cursor_t *cursor)
       cursor->impl.destroy (&cursor->impl);
    }
 
-   /* Always close the socket for an exhaust cursor, even if the client was
-    * reset with mongoc_client_reset. That prevents further use of that socket.
-    */
-   if (cursor->in_exhaust) {
+   if (cursor->exhaust_server_stream) {
+      if (!cursor->cursor_id && !cursor->error.domain && !cursor->exhaust_server_stream->more_to_come) {
+         /* the server sent its last reply: the connection can be reused */
+         mongoc_cluster_attach_node (
+            &cursor->client->cluster, cursor->exhaust_server_stream->sd->id, cursor->exhaust_node);
+      } else {
+         /* Closing the cursor's own connection also stops the server from
+          * streaming more replies. */
+         mongoc_cluster_node_destroy (cursor->exhaust_node);
+      }
+      mongoc_server_stream_cleanup (cursor->exhaust_server_stream);
+   } else if (cursor->in_exhaust) {
+      /* Always close the socket for an exhaust cursor, even if the client was
+       * reset with mongoc_client_reset. That prevents further use of that
+       * socket. */
       cursor->client->in_exhaust = false;
       if (cursor->state != DONE) {
          /* The only way to stop an exhaust cursor is to kill the connection
@@ -889,7 +900,13 @@ _mongoc_cursor_run_command (
    parts.is_read_command = true;
    parts.read_prefs = cursor->read_prefs;
    parts.assembled.operation_id = cursor->operation_id;
-   server_stream = _mongoc_cursor_fetch_stream (cursor);
+
+   if (cursor->exhaust_server_stream) {
+      /* read the next reply the server streams on the cursor's connection */
+      server_stream = cursor->exhaust_server_stream;
+   } else {
+      server_stream = _mongoc_cursor_fetch_stream (cursor);
+   }
 
    if (!server_stream) {
       _mongoc_bson_init_if_set (reply);
@@ -1058,7 +1075,20 @@ retry:
    }
 
 done:
-   mongoc_server_stream_cleanup (server_stream);
+   if (server_stream && server_stream->more_to_come && !cursor->exhaust_server_stream &&
+       !cursor->client->topology->single_threaded) {
+      /* The server streams the rest of the results on this connection: take it
+       * out of the client's cluster for the lifetime of the cursor. */
+      cursor->exhaust_node = mongoc_cluster_detach_node (&cursor->client->cluster, server_stream->sd->id);
+      if (cursor->exhaust_node) {
+         cursor->exhaust_server_stream = server_stream;
+      }
+   }
+
+   if (server_stream != cursor->exhaust_server_stream) {
+      mongoc_server_stream_cleanup (server_stream);
+   }
+
    mongoc_cmd_parts_cleanup (&parts);
    mongoc_read_prefs_destroy (prefs);
    bson_free (db);
@@ -1244,6 +1274,59 @@ done:
 }
 
 
+bool
+mongoc_cursor_next_batch (mongoc_cursor_t *cursor, bson_t *documents, size_t max_documents, size_t *n_documents)
+{
+   const bson_t *doc;
+   size_t n = 0u;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM (cursor);
+   BSON_ASSERT_PARAM (documents);
+   BSON_ASSERT_PARAM (n_documents);
+   BSON_ASSERT (max_documents > 0u);
+
+   *n_documents = 0u;
+
+   /* the first document may require a round trip, handle it like any other
+    * call to mongoc_cursor_next. */
+   if (!mongoc_cursor_next (cursor, &doc)) {
+      RETURN (false);
+   }
+
+   BSON_ASSERT (bson_init_static (&documents[n++], bson_get_data (doc), doc->len));
+
+   /* drain the rest of the batch that is already in memory. the documents
+    * point into the server reply, which stays alive until the next batch is
+    * requested, so each one remains valid after popping the next. */
+   while (n < max_documents && cursor->state == IN_BATCH) {
+      doc = cursor->current;
+      cursor->current = NULL;
+      cursor->state = _call_transition (cursor);
+
+      if (!cursor->current) {
+         /* keep mongoc_cursor_current pointing at the last document returned */
+         cursor->current = doc;
+         /* the pop found the end of the last batch. leave it to the next call
+          * to find it again, so that, as with mongoc_cursor_next, the cursor
+          * only completes when a call returns no documents. */
+         if (cursor->state == DONE && !cursor->error.domain) {
+            cursor->state = IN_BATCH;
+         }
+         break;
+      }
+
+      BSON_ASSERT (bson_init_static (&documents[n++], bson_get_data (cursor->current), cursor->current->len));
+      cursor->count++;
+   }
+
+   *n_documents = n;
+
+   RETURN (true);
+}
+
+
 bool
 mongoc_cursor_more (mongoc_cursor_t *cursor)
 {
@@ -1296,6 +1379,7 @@ mongoc_cursor_clone (const mongoc_cursor_t *cursor)
    _clone = BSON_ALIGNED_ALLOC0 (mongoc_cursor_t);
 
    _clone->client = cursor->client;
+   _clone->client_generation = cursor->client->generation;
    _clone->nslen = cursor->nslen;
    _clone->dblen = cursor->dblen;
    _clone->explicit_session = cursor->explicit_session;
@@ -1625,7 +1709,8 @@ _mongoc_cursor_response_refresh (mongoc_cursor_t *cursor,
     * to getMore command with {cursor: {id: N, nextBatch: []}}. */
    if (_mongoc_cursor_run_command (cursor, command, opts, &response->reply, false)) {
       if (_mongoc_cursor_start_reading_response (cursor, response)) {
-         cursor->in_exhaust = cursor->client->in_exhaust;
+         cursor->in_exhaust = cursor->client->in_exhaust ||
+                              (cursor->exhaust_server_stream && cursor->exhaust_server_stream->more_to_come);
          return;
       }
    }
@@ -42,6 +42,8 @@ mongoc_cursor_more (mongoc_cursor_t *cursor);
 MONGOC_EXPORT (bool)
 mongoc_cursor_next (mongoc_cursor_t *cursor, const bson_t **bson);
 MONGOC_EXPORT (bool)
+mongoc_cursor_next_batch (mongoc_cursor_t *cursor, bson_t *documents, size_t max_documents, size_t *n_documents);
+MONGOC_EXPORT (bool)
 mongoc_cursor_error (mongoc_cursor_t *cursor, bson_error_t *error);
 MONGOC_EXPORT (bool)
 mongoc_cursor_error_document (mongoc_cursor_t *cursor, bson_error_t *error, const bson_t **doc);
@@ -19,6 +19,7 @@
 #include "mongoc-client-private.h"
 #include "mongoc-host-list-private.h"
 #include "mongoc-stream-tls.h"
+#include "mongoc-stream-tls-private.h"
 #include "mongoc-stream-private.h"
 #include "mongoc-buffer-private.h"
 #include "mcd-time.h"
@@ -147,7 +148,7 @@ _mongoc_http_send (const mongoc_http_request_t *req,
       mongoc_stream_t *tls_stream;
 
       BSON_ASSERT (ssl_opts);
-      tls_stream = mongoc_stream_tls_new_with_hostname (stream, req->host, ssl_opts, true);
+      tls_stream = _mongoc_stream_tls_new_with_hostname_and_port (stream, req->host, host_list.port, ssl_opts, true);
       if (!tls_stream) {
          bson_set_error (
             error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_SOCKET, "Failed create TLS stream to: %s", req->host);
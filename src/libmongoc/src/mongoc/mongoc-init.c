@@ -22,11 +22,14 @@
 #include "mongoc-init.h"
 
 #include "mongoc-handshake-private.h"
+#include "mongoc-client-pool-private.h"
 
 #include "mongoc-cluster-aws-private.h"
+#include "mongoc-scram-private.h"
 
 #ifdef MONGOC_ENABLE_SSL_OPENSSL
 #include "mongoc-openssl-private.h"
+#include "mongoc-openssl-session-cache-private.h"
 #elif defined(MONGOC_ENABLE_SSL_LIBRESSL)
 #include "tls.h"
 #endif
@@ -143,6 +146,8 @@ static BSON_ONCE_FUN (_mongoc_do_init)
 
    _mongoc_handshake_init ();
 
+   _mongoc_client_pool_shared_topologies_init ();
+
 #if defined(MONGOC_ENABLE_MONGODB_AWS_AUTH)
    kms_message_init ();
    _mongoc_aws_credentials_cache_init ();
@@ -152,6 +157,10 @@ static BSON_ONCE_FUN (_mongoc_do_init)
    _mongoc_ocsp_cache_init ();
 #endif
 
+#if defined(MONGOC_ENABLE_OPENSSL_SESSION_CACHE)
+   _mongoc_openssl_session_cache_init ();
+#endif
+
    BSON_ONCE_RETURN;
 }
 
@@ -189,6 +198,12 @@ static BSON_ONCE_FUN (_mongoc_do_cleanup)
 
    _mongoc_handshake_cleanup ();
 
+   _mongoc_client_pool_shared_topologies_cleanup ();
+
+#if defined(MONGOC_ENABLE_CRYPTO)
+   _mongoc_scram_cache_clear ();
+#endif
+
 #if defined(MONGOC_ENABLE_MONGODB_AWS_AUTH)
    kms_message_cleanup ();
    _mongoc_aws_credentials_cache_cleanup ();
@@ -198,6 +213,10 @@ static BSON_ONCE_FUN (_mongoc_do_cleanup)
    _mongoc_ocsp_cache_cleanup ();
 #endif
 
+#if defined(MONGOC_ENABLE_OPENSSL_SESSION_CACHE)
+   _mongoc_openssl_session_cache_cleanup ();
+#endif
+
    BSON_ONCE_RETURN;
 }
 
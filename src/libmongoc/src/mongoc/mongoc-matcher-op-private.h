@@ -21,6 +21,8 @@
 
 #include <bson/bson.h>
 
+#include "mongoc-array-private.h"
+
 
 BSON_BEGIN_DECLS
 
@@ -32,6 +34,7 @@ typedef struct _mongoc_matcher_op_compare_t mongoc_matcher_op_compare_t;
 typedef struct _mongoc_matcher_op_exists_t mongoc_matcher_op_exists_t;
 typedef struct _mongoc_matcher_op_type_t mongoc_matcher_op_type_t;
 typedef struct _mongoc_matcher_op_not_t mongoc_matcher_op_not_t;
+typedef struct _mongoc_matcher_in_set_t mongoc_matcher_in_set_t;
 
 
 typedef enum {
@@ -57,6 +60,21 @@ struct _mongoc_matcher_op_base_t {
 };
 
 
+/* A top-level field of the matched document, found once per document for all
+ * ops whose path starts with its name. See _mongoc_matcher_op_compile. */
+typedef struct _mongoc_matcher_field_t {
+   bool found;
+   bson_iter_t iter;
+} mongoc_matcher_field_t;
+
+
+/* The name of a top-level field that ops refer to. */
+typedef struct _mongoc_matcher_field_name_t {
+   const char *name;
+   size_t len;
+} mongoc_matcher_field_name_t;
+
+
 struct _mongoc_matcher_op_logical_t {
    mongoc_matcher_op_base_t base;
    mongoc_matcher_op_t *left;
@@ -67,13 +85,21 @@ struct _mongoc_matcher_op_logical_t {
 struct _mongoc_matcher_op_compare_t {
    mongoc_matcher_op_base_t base;
    char *path;
+   /* the path's first segment, as an index into the matched fields, and the
+    * rest of a dotted path or NULL. Set by _mongoc_matcher_op_compile. */
+   size_t field;
+   const char *subpath;
    bson_iter_t iter;
+   /* for $in and $nin, the strings and integers of the array, hashed */
+   mongoc_matcher_in_set_t *in_set;
 };
 
 
 struct _mongoc_matcher_op_exists_t {
    mongoc_matcher_op_base_t base;
    char *path;
+   size_t field;
+   const char *subpath;
    bool exists;
 };
 
@@ -82,6 +108,8 @@ struct _mongoc_matcher_op_type_t {
    mongoc_matcher_op_base_t base;
    bson_type_t type;
    char *path;
+   size_t field;
+   const char *subpath;
 };
 
 
@@ -112,8 +140,16 @@ mongoc_matcher_op_t *
 _mongoc_matcher_op_type_new (const char *path, bson_type_t type);
 mongoc_matcher_op_t *
 _mongoc_matcher_op_not_new (const char *path, mongoc_matcher_op_t *child);
+void
+_mongoc_matcher_op_compile (mongoc_matcher_op_t *op, mongoc_array_t *field_names);
 bool
-_mongoc_matcher_op_match (mongoc_matcher_op_t *op, const bson_t *bson);
+_mongoc_matcher_op_match (mongoc_matcher_op_t *op, const mongoc_matcher_field_t *fields);
+void
+_mongoc_matcher_op_match_batch (mongoc_matcher_op_t *op,
+                                const mongoc_matcher_field_t *fields,
+                                size_t n_fields,
+                                size_t n_documents,
+                                uint8_t *selection);
 void
 _mongoc_matcher_op_destroy (mongoc_matcher_op_t *op);
 void
@@ -18,6 +18,97 @@
 #include "mongoc-log.h"
 #include "mongoc-matcher-op-private.h"
 #include "mongoc-util-private.h"
+#include "uthash.h"
+
+
+typedef struct {
+   const char *str; // Hash key.
+   uint32_t len;
+   UT_hash_handle hh;
+} _in_str_t;
+
+typedef struct {
+   int64_t value; // Hash key.
+   UT_hash_handle hh;
+} _in_int_t;
+
+struct _mongoc_matcher_in_set_t {
+   _in_str_t *strs;
+   _in_int_t *ints;
+   /* true if the array has elements that are not strings or integers */
+   bool has_others;
+};
+
+
+static mongoc_matcher_in_set_t *
+_mongoc_matcher_in_set_new (const bson_iter_t *array)
+{
+   mongoc_matcher_in_set_t *set;
+   bson_iter_t iter;
+
+   if (!BSON_ITER_HOLDS_ARRAY (array) || !bson_iter_recurse (array, &iter)) {
+      return NULL;
+   }
+
+   set = bson_malloc0 (sizeof *set);
+
+   while (bson_iter_next (&iter)) {
+      if (BSON_ITER_HOLDS_UTF8 (&iter)) {
+         _in_str_t *entry;
+         uint32_t len;
+         const char *str = bson_iter_utf8 (&iter, &len);
+
+         HASH_FIND (hh, set->strs, str, len, entry);
+         if (!entry) {
+            entry = bson_malloc0 (sizeof *entry);
+            entry->str = str;
+            entry->len = len;
+            HASH_ADD_KEYPTR (hh, set->strs, entry->str, entry->len, entry);
+         }
+      } else if (BSON_ITER_HOLDS_INT32 (&iter) || BSON_ITER_HOLDS_INT64 (&iter)) {
+         _in_int_t *entry;
+         int64_t value = bson_iter_as_int64 (&iter);
+
+         HASH_FIND (hh, set->ints, &value, sizeof value, entry);
+         if (!entry) {
+            entry = bson_malloc0 (sizeof *entry);
+            entry->value = value;
+            HASH_ADD (hh, set->ints, value, sizeof entry->value, entry);
+         }
+      } else {
+         set->has_others = true;
+      }
+   }
+
+   return set;
+}
+
+
+static void
+_mongoc_matcher_in_set_destroy (mongoc_matcher_in_set_t *set)
+{
+   _in_str_t *str, *str_tmp;
+   _in_int_t *i, *i_tmp;
+
+   if (!set) {
+      return;
+   }
+
+   HASH_ITER (hh, set->strs, str, str_tmp)
+   {
+      HASH_DEL (set->strs, str);
+      bson_free (str);
+   }
+
+   HASH_ITER (hh, set->ints, i, i_tmp)
+   {
+      HASH_DEL (set->ints, i);
+      bson_free (i);
+   }
+
+   bson_free (set);
+}
+
 
 /*
  *--------------------------------------------------------------------------
@@ -169,6 +260,10 @@ _mongoc_matcher_op_compare_new (mongoc_matcher_opcode_t opcode, /* IN */
    op->compare.path = bson_strdup (path);
    memcpy (&op->compare.iter, iter, sizeof *iter);
 
+   if (opcode == MONGOC_MATCHER_OPCODE_IN || opcode == MONGOC_MATCHER_OPCODE_NIN) {
+      op->compare.in_set = _mongoc_matcher_in_set_new (iter);
+   }
+
    return op;
 }
 
@@ -238,6 +333,7 @@ _mongoc_matcher_op_destroy (mongoc_matcher_op_t *op) /* IN */
    case MONGOC_MATCHER_OPCODE_NE:
    case MONGOC_MATCHER_OPCODE_NIN:
       bson_free (op->compare.path);
+      _mongoc_matcher_in_set_destroy (op->compare.in_set);
       break;
    case MONGOC_MATCHER_OPCODE_OR:
    case MONGOC_MATCHER_OPCODE_AND:
@@ -265,6 +361,112 @@ _mongoc_matcher_op_destroy (mongoc_matcher_op_t *op) /* IN */
 }
 
 
+/* Return the index of the top-level field named by the first segment of
+ * @path, adding it to @field_names if needed. Sets @subpath to the rest of a
+ * dotted path, or NULL. */
+static size_t
+_mongoc_matcher_field_index (mongoc_array_t *field_names, const char *path, const char **subpath)
+{
+   const char *dot = strchr (path, '.');
+   mongoc_matcher_field_name_t name = {.name = path, .len = dot ? (size_t) (dot - path) : strlen (path)};
+
+   *subpath = dot ? dot + 1 : NULL;
+
+   for (size_t i = 0; i < field_names->len; i++) {
+      const mongoc_matcher_field_name_t *other = &_mongoc_array_index (field_names, mongoc_matcher_field_name_t, i);
+      if (other->len == name.len && 0 == memcmp (other->name, name.name, name.len)) {
+         return i;
+      }
+   }
+
+   _mongoc_array_append_val (field_names, name);
+   return field_names->len - 1;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_matcher_op_compile --
+ *
+ *       Resolve the paths of @op and its children to top-level fields of
+ *       the matched document, so each document is iterated once per
+ *       match rather than once per op.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       Appends the names of the fields to @field_names, an array of
+ *       mongoc_matcher_field_name_t that refer to the paths of the ops.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_matcher_op_compile (mongoc_matcher_op_t *op,      /* IN */
+                            mongoc_array_t *field_names) /* IN */
+{
+   BSON_ASSERT (op);
+   BSON_ASSERT (field_names);
+
+   switch (op->base.opcode) {
+   case MONGOC_MATCHER_OPCODE_EQ:
+   case MONGOC_MATCHER_OPCODE_GT:
+   case MONGOC_MATCHER_OPCODE_GTE:
+   case MONGOC_MATCHER_OPCODE_IN:
+   case MONGOC_MATCHER_OPCODE_LT:
+   case MONGOC_MATCHER_OPCODE_LTE:
+   case MONGOC_MATCHER_OPCODE_NE:
+   case MONGOC_MATCHER_OPCODE_NIN:
+      op->compare.field = _mongoc_matcher_field_index (field_names, op->compare.path, &op->compare.subpath);
+      break;
+   case MONGOC_MATCHER_OPCODE_OR:
+   case MONGOC_MATCHER_OPCODE_AND:
+   case MONGOC_MATCHER_OPCODE_NOR:
+      if (op->logical.left)
+         _mongoc_matcher_op_compile (op->logical.left, field_names);
+      if (op->logical.right)
+         _mongoc_matcher_op_compile (op->logical.right, field_names);
+      break;
+   case MONGOC_MATCHER_OPCODE_NOT:
+      _mongoc_matcher_op_compile (op->not_.child, field_names);
+      break;
+   case MONGOC_MATCHER_OPCODE_EXISTS:
+      op->exists.field = _mongoc_matcher_field_index (field_names, op->exists.path, &op->exists.subpath);
+      break;
+   case MONGOC_MATCHER_OPCODE_TYPE:
+      op->type.field = _mongoc_matcher_field_index (field_names, op->type.path, &op->type.subpath);
+      break;
+   default:
+      break;
+   }
+}
+
+
+/* Find the value at a compiled path, like bson_iter_find_descendant. */
+static bool
+_mongoc_matcher_find (const mongoc_matcher_field_t *fields, size_t field, const char *subpath, bson_iter_t *iter)
+{
+   bson_iter_t child;
+
+   if (!fields[field].found) {
+      return false;
+   }
+
+   if (!subpath) {
+      *iter = fields[field].iter;
+      return true;
+   }
+
+   if (BSON_ITER_HOLDS_DOCUMENT (&fields[field].iter) || BSON_ITER_HOLDS_ARRAY (&fields[field].iter)) {
+      return bson_iter_recurse (&fields[field].iter, &child) && bson_iter_find_descendant (&child, subpath, iter);
+   }
+
+   return false;
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -287,17 +489,16 @@ _mongoc_matcher_op_destroy (mongoc_matcher_op_t *op) /* IN */
  */
 
 static bool
-_mongoc_matcher_op_exists_match (mongoc_matcher_op_exists_t *exists, /* IN */
-                                 const bson_t *bson)                 /* IN */
+_mongoc_matcher_op_exists_match (mongoc_matcher_op_exists_t *exists,  /* IN */
+                                 const mongoc_matcher_field_t *fields) /* IN */
 {
-   bson_iter_t iter;
    bson_iter_t desc;
    bool found;
 
    BSON_ASSERT (exists);
-   BSON_ASSERT (bson);
+   BSON_ASSERT (fields);
 
-   found = (bson_iter_init (&iter, bson) && bson_iter_find_descendant (&iter, exists->path, &desc));
+   found = _mongoc_matcher_find (fields, exists->field, exists->subpath, &desc);
 
    return (found == exists->exists);
 }
@@ -321,17 +522,16 @@ _mongoc_matcher_op_exists_match (mongoc_matcher_op_exists_t *exists, /* IN */
  */
 
 static bool
-_mongoc_matcher_op_type_match (mongoc_matcher_op_type_t *type, /* IN */
-                               const bson_t *bson)             /* IN */
+_mongoc_matcher_op_type_match (mongoc_matcher_op_type_t *type,      /* IN */
+                               const mongoc_matcher_field_t *fields) /* IN */
 {
-   bson_iter_t iter;
    bson_iter_t desc;
 
    BSON_ASSERT (type);
-   BSON_ASSERT (bson);
+   BSON_ASSERT (fields);
 
-   if (bson_iter_init (&iter, bson) && bson_iter_find_descendant (&iter, type->path, &desc)) {
-      return (bson_iter_type (&iter) == type->type);
+   if (_mongoc_matcher_find (fields, type->field, type->subpath, &desc)) {
+      return (bson_iter_type (&desc) == type->type);
    }
 
    return false;
@@ -357,13 +557,13 @@ _mongoc_matcher_op_type_match (mongoc_matcher_op_type_t *type, /* IN */
  */
 
 static bool
-_mongoc_matcher_op_not_match (mongoc_matcher_op_not_t *not_, /* IN */
-                              const bson_t *bson)            /* IN */
+_mongoc_matcher_op_not_match (mongoc_matcher_op_not_t *not_,        /* IN */
+                              const mongoc_matcher_field_t *fields) /* IN */
 {
    BSON_ASSERT (not_);
-   BSON_ASSERT (bson);
+   BSON_ASSERT (fields);
 
-   return !_mongoc_matcher_op_match (not_->child, bson);
+   return !_mongoc_matcher_op_match (not_->child, fields);
 }
 
 
@@ -698,6 +898,28 @@ _mongoc_matcher_op_in_match (mongoc_matcher_op_compare_t *compare, /* IN */
                              bson_iter_t *iter)                    /* IN */
 {
    mongoc_matcher_op_compare_t op;
+   const mongoc_matcher_in_set_t *set = compare->in_set;
+
+   /* A string only equals a string, and an integer equals an integer of the
+    * same value or a double. Other types are compared one by one. */
+   if (set && BSON_ITER_HOLDS_UTF8 (iter)) {
+      _in_str_t *entry;
+      uint32_t len;
+      const char *str = bson_iter_utf8 (iter, &len);
+
+      HASH_FIND (hh, set->strs, str, len, entry);
+      return entry != NULL;
+   }
+
+   if (set && (BSON_ITER_HOLDS_INT32 (iter) || BSON_ITER_HOLDS_INT64 (iter))) {
+      _in_int_t *entry;
+      int64_t value = bson_iter_as_int64 (iter);
+
+      HASH_FIND (hh, set->ints, &value, sizeof value, entry);
+      if (entry || !set->has_others) {
+         return entry != NULL;
+      }
+   }
 
    op.base.opcode = MONGOC_MATCHER_OPCODE_EQ;
    op.path = compare->path;
@@ -922,19 +1144,14 @@ _mongoc_matcher_op_nin_match (mongoc_matcher_op_compare_t *compare, /* IN */
 
 static bool
 _mongoc_matcher_op_compare_match (mongoc_matcher_op_compare_t *compare, /* IN */
-                                  const bson_t *bson)                   /* IN */
+                                  const mongoc_matcher_field_t *fields) /* IN */
 {
-   bson_iter_t tmp;
    bson_iter_t iter;
 
    BSON_ASSERT (compare);
-   BSON_ASSERT (bson);
+   BSON_ASSERT (fields);
 
-   if (strchr (compare->path, '.')) {
-      if (!bson_iter_init (&tmp, bson) || !bson_iter_find_descendant (&tmp, compare->path, &iter)) {
-         return false;
-      }
-   } else if (!bson_iter_init_find (&iter, bson, compare->path)) {
+   if (!_mongoc_matcher_find (fields, compare->field, compare->subpath, &iter)) {
       return false;
    }
 
@@ -983,18 +1200,18 @@ _mongoc_matcher_op_compare_match (mongoc_matcher_op_compare_t *compare, /* IN */
 
 static bool
 _mongoc_matcher_op_logical_match (mongoc_matcher_op_logical_t *logical, /* IN */
-                                  const bson_t *bson)                   /* IN */
+                                  const mongoc_matcher_field_t *fields) /* IN */
 {
    BSON_ASSERT (logical);
-   BSON_ASSERT (bson);
+   BSON_ASSERT (fields);
 
    switch ((int) logical->base.opcode) {
    case MONGOC_MATCHER_OPCODE_OR:
-      return (_mongoc_matcher_op_match (logical->left, bson) || _mongoc_matcher_op_match (logical->right, bson));
+      return (_mongoc_matcher_op_match (logical->left, fields) || _mongoc_matcher_op_match (logical->right, fields));
    case MONGOC_MATCHER_OPCODE_AND:
-      return (_mongoc_matcher_op_match (logical->left, bson) && _mongoc_matcher_op_match (logical->right, bson));
+      return (_mongoc_matcher_op_match (logical->left, fields) && _mongoc_matcher_op_match (logical->right, fields));
    case MONGOC_MATCHER_OPCODE_NOR:
-      return !(_mongoc_matcher_op_match (logical->left, bson) || _mongoc_matcher_op_match (logical->right, bson));
+      return !(_mongoc_matcher_op_match (logical->left, fields) || _mongoc_matcher_op_match (logical->right, fields));
    default:
       BSON_ASSERT (false);
       break;
@@ -1021,11 +1238,11 @@ _mongoc_matcher_op_logical_match (mongoc_matcher_op_logical_t *logical, /* IN */
  */
 
 bool
-_mongoc_matcher_op_match (mongoc_matcher_op_t *op, /* IN */
-                          const bson_t *bson)      /* IN */
+_mongoc_matcher_op_match (mongoc_matcher_op_t *op,              /* IN */
+                          const mongoc_matcher_field_t *fields) /* IN */
 {
    BSON_ASSERT (op);
-   BSON_ASSERT (bson);
+   BSON_ASSERT (fields);
 
    switch (op->base.opcode) {
    case MONGOC_MATCHER_OPCODE_EQ:
@@ -1036,17 +1253,17 @@ _mongoc_matcher_op_match (mongoc_matcher_op_t *op, /* IN */
    case MONGOC_MATCHER_OPCODE_LTE:
    case MONGOC_MATCHER_OPCODE_NE:
    case MONGOC_MATCHER_OPCODE_NIN:
-      return _mongoc_matcher_op_compare_match (&op->compare, bson);
+      return _mongoc_matcher_op_compare_match (&op->compare, fields);
    case MONGOC_MATCHER_OPCODE_OR:
    case MONGOC_MATCHER_OPCODE_AND:
    case MONGOC_MATCHER_OPCODE_NOR:
-      return _mongoc_matcher_op_logical_match (&op->logical, bson);
+      return _mongoc_matcher_op_logical_match (&op->logical, fields);
    case MONGOC_MATCHER_OPCODE_NOT:
-      return _mongoc_matcher_op_not_match (&op->not_, bson);
+      return _mongoc_matcher_op_not_match (&op->not_, fields);
    case MONGOC_MATCHER_OPCODE_EXISTS:
-      return _mongoc_matcher_op_exists_match (&op->exists, bson);
+      return _mongoc_matcher_op_exists_match (&op->exists, fields);
    case MONGOC_MATCHER_OPCODE_TYPE:
-      return _mongoc_matcher_op_type_match (&op->type, bson);
+      return _mongoc_matcher_op_type_match (&op->type, fields);
    default:
       break;
    }
@@ -1055,6 +1272,58 @@ _mongoc_matcher_op_match (mongoc_matcher_op_t *op, /* IN */
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_matcher_op_match_batch --
+ *
+ *       Match @op against @n_documents documents. The fields of document
+ *       i start at @fields + i * @n_fields. Only documents whose bit is
+ *       set in @selection are evaluated.
+ *
+ *       The operands of an $and are applied one at a time to the whole
+ *       batch, so each later operand only sees the documents that
+ *       matched the earlier ones.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       Clears the bit in @selection of each document that does not
+ *       match.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_matcher_op_match_batch (mongoc_matcher_op_t *op,              /* IN */
+                                const mongoc_matcher_field_t *fields, /* IN */
+                                size_t n_fields,                      /* IN */
+                                size_t n_documents,                   /* IN */
+                                uint8_t *selection)                   /* INOUT */
+{
+   BSON_ASSERT (op);
+   BSON_ASSERT (fields);
+   BSON_ASSERT (selection);
+
+   if (op->base.opcode == MONGOC_MATCHER_OPCODE_AND) {
+      _mongoc_matcher_op_match_batch (op->logical.left, fields, n_fields, n_documents, selection);
+      if (op->logical.right) {
+         _mongoc_matcher_op_match_batch (op->logical.right, fields, n_fields, n_documents, selection);
+      }
+      return;
+   }
+
+   for (size_t i = 0; i < n_documents; i++) {
+      const uint8_t bit = (uint8_t) (1u << (i % 8u));
+
+      if ((selection[i / 8u] & bit) && !_mongoc_matcher_op_match (op, fields + i * n_fields)) {
+         selection[i / 8u] &= (uint8_t) ~bit;
+      }
+   }
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -30,6 +30,8 @@ BSON_BEGIN_DECLS
 struct _mongoc_matcher_t {
    bson_t query;
    mongoc_matcher_op_t *optree;
+   /* the top-level fields the ops refer to, as mongoc_matcher_field_name_t */
+   mongoc_array_t field_names;
 };
 
 
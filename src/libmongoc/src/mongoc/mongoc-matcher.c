@@ -315,6 +315,8 @@ mongoc_matcher_new (const bson_t *query, /* IN */
    }
 
    matcher->optree = op;
+   _mongoc_array_init (&matcher->field_names, sizeof (mongoc_matcher_field_name_t));
+   _mongoc_matcher_op_compile (op, &matcher->field_names);
 
    return matcher;
 
@@ -325,6 +327,40 @@ failure:
 }
 
 
+/* Find every field the ops of @matcher refer to in a single pass over
+ * @document. */
+static void
+_mongoc_matcher_find_fields (const mongoc_matcher_t *matcher, const bson_t *document, mongoc_matcher_field_t *fields)
+{
+   const size_t n_fields = matcher->field_names.len;
+   size_t n_found = 0;
+   bson_iter_t iter;
+
+   for (size_t i = 0; i < n_fields; i++) {
+      fields[i].found = false;
+   }
+
+   if (n_fields > 0 && bson_iter_init (&iter, document)) {
+      while (n_found < n_fields && bson_iter_next (&iter)) {
+         const char *key = bson_iter_key (&iter);
+         const size_t key_len = bson_iter_key_len (&iter);
+
+         for (size_t i = 0; i < n_fields; i++) {
+            const mongoc_matcher_field_name_t *name =
+               &_mongoc_array_index (&matcher->field_names, mongoc_matcher_field_name_t, i);
+
+            if (!fields[i].found && name->len == key_len && 0 == memcmp (name->name, key, key_len)) {
+               fields[i].found = true;
+               fields[i].iter = iter;
+               n_found++;
+               break;
+            }
+         }
+      }
+   }
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -346,11 +382,95 @@ bool
 mongoc_matcher_match (const mongoc_matcher_t *matcher, /* IN */
                       const bson_t *document)          /* IN */
 {
+   mongoc_matcher_field_t stack_fields[16] = {{0}};
+   mongoc_matcher_field_t *fields = stack_fields;
+   bool ret;
+
    BSON_ASSERT (matcher);
    BSON_ASSERT (matcher->optree);
    BSON_ASSERT (document);
 
-   return _mongoc_matcher_op_match (matcher->optree, document);
+   if (matcher->field_names.len > sizeof stack_fields / sizeof stack_fields[0]) {
+      fields = bson_malloc0 (matcher->field_names.len * sizeof *fields);
+   }
+
+   _mongoc_matcher_find_fields (matcher, document, fields);
+   ret = _mongoc_matcher_op_match (matcher->optree, fields);
+
+   if (fields != stack_fields) {
+      bson_free (fields);
+   }
+
+   return ret;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_matcher_match_batch --
+ *
+ *       Checks which of the @n_documents documents in @documents match
+ *       the query specified when creating @matcher.
+ *
+ *       @selection must hold at least (@n_documents + 7) / 8 bytes. Bit
+ *       (i % 8) of byte (i / 8) is set if documents[i] matched, and
+ *       cleared otherwise.
+ *
+ * Returns:
+ *       The number of documents that matched.
+ *
+ * Side effects:
+ *       @selection is set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+size_t
+mongoc_matcher_match_batch (const mongoc_matcher_t *matcher, /* IN */
+                            const bson_t *const *documents,  /* IN */
+                            size_t n_documents,              /* IN */
+                            uint8_t *selection)              /* OUT */
+{
+   mongoc_matcher_field_t *fields;
+   size_t n_fields;
+   size_t n_matched = 0;
+
+   BSON_ASSERT (matcher);
+   BSON_ASSERT (matcher->optree);
+   BSON_ASSERT (documents || n_documents == 0);
+   BSON_ASSERT (selection || n_documents == 0);
+
+   if (n_documents == 0) {
+      return 0;
+   }
+
+   /* each document gets at least one slot, so that fields is not NULL */
+   n_fields = BSON_MAX (matcher->field_names.len, 1u);
+   fields = bson_malloc0 (n_documents * n_fields * sizeof *fields);
+
+   for (size_t i = 0; i < n_documents; i++) {
+      BSON_ASSERT (documents[i]);
+      _mongoc_matcher_find_fields (matcher, documents[i], fields + i * n_fields);
+   }
+
+   memset (selection, 0xff, (n_documents + 7u) / 8u);
+   _mongoc_matcher_op_match_batch (matcher->optree, fields, n_fields, n_documents, selection);
+
+   for (size_t i = 0; i < n_documents; i++) {
+      if (selection[i / 8u] & (1u << (i % 8u))) {
+         n_matched++;
+      }
+   }
+
+   /* clear the unused bits of the last byte */
+   if (n_documents % 8u) {
+      selection[n_documents / 8u] &= (uint8_t) ((1u << (n_documents % 8u)) - 1u);
+   }
+
+   bson_free (fields);
+
+   return n_matched;
 }
 
 
@@ -376,6 +496,7 @@ mongoc_matcher_destroy (mongoc_matcher_t *matcher) /* IN */
    BSON_ASSERT (matcher);
 
    _mongoc_matcher_op_destroy (matcher->optree);
+   _mongoc_array_destroy (&matcher->field_names);
    bson_destroy (&matcher->query);
    bson_free (matcher);
 }
@@ -33,6 +33,11 @@ MONGOC_EXPORT (mongoc_matcher_t *)
 mongoc_matcher_new (const bson_t *query, bson_error_t *error) BSON_GNUC_WARN_UNUSED_RESULT BSON_GNUC_DEPRECATED;
 MONGOC_EXPORT (bool)
 mongoc_matcher_match (const mongoc_matcher_t *matcher, const bson_t *document) BSON_GNUC_DEPRECATED;
+MONGOC_EXPORT (size_t)
+mongoc_matcher_match_batch (const mongoc_matcher_t *matcher,
+                            const bson_t *const *documents,
+                            size_t n_documents,
+                            uint8_t *selection) BSON_GNUC_DEPRECATED;
 MONGOC_EXPORT (void)
 mongoc_matcher_destroy (mongoc_matcher_t *matcher) BSON_GNUC_DEPRECATED;
 
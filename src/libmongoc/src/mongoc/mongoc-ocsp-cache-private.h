@@ -36,6 +36,8 @@ _mongoc_ocsp_cache_set_resp (
 int
 _mongoc_ocsp_cache_length (void);
 
+/* On success, "this_update" and "next_update" are set to copies of the cached
+ * times. The caller must free them with ASN1_GENERALIZEDTIME_free. */
 bool
 _mongoc_ocsp_cache_get_status (OCSP_CERTID *id,
                                int *cert_status,
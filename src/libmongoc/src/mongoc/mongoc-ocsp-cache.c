@@ -18,44 +18,59 @@
 #include "mongoc-ocsp-cache-private.h"
 #ifdef MONGOC_ENABLE_OCSP_OPENSSL
 
-#include "utlist.h"
+#include "uthash.h"
 #include "mongoc-trace-private.h"
 #include <bson/bson.h>
 #include <common-thread-private.h>
 
-typedef struct _cache_entry_list_t {
-   struct _cache_entry_list_t *next;
+/* Entries are keyed by the DER encoding of their OCSP_CERTID, so a lookup
+ * hashes the id once instead of calling OCSP_id_cmp on every entry. */
+typedef struct _cache_entry_t {
+   unsigned char *key;
+   int key_len;
    OCSP_CERTID *id;
    int cert_status, reason;
    ASN1_GENERALIZEDTIME *this_update, *next_update;
-} cache_entry_list_t;
+   UT_hash_handle hh;
+} cache_entry_t;
 
-static cache_entry_list_t *cache;
-static bson_mutex_t ocsp_cache_mutex;
+static cache_entry_t *cache;
+
+/* Every handshake looks up its peer's status, but responses only change when
+ * a new one is stapled or fetched. Lookups take the lock in shared mode so
+ * concurrent handshakes do not serialize on each other. */
+static bson_shared_mutex_t ocsp_cache_mutex;
 
 void
 _mongoc_ocsp_cache_init (void)
 {
-   bson_mutex_init (&ocsp_cache_mutex);
+   bson_shared_mutex_init (&ocsp_cache_mutex);
 }
 
-static int
-cache_cmp (cache_entry_list_t *out, OCSP_CERTID *id)
+/* Returns the DER encoding of "id" in a buffer allocated with
+ * OPENSSL_malloc, or NULL on failure. */
+static unsigned char *
+encode_id (OCSP_CERTID *id, int *len)
 {
-   ENTRY;
-   if (!out || !out->id || !id)
-      RETURN (1);
-   RETURN (OCSP_id_cmp (out->id, id));
+   unsigned char *key = NULL;
+
+   *len = i2d_OCSP_CERTID (id, &key);
+   if (*len <= 0) {
+      return NULL;
+   }
+
+   return key;
 }
 
-static cache_entry_list_t *
-get_cache_entry (OCSP_CERTID *id)
+/* Caller must hold ocsp_cache_mutex, in shared or exclusive mode. */
+static cache_entry_t *
+get_cache_entry (const unsigned char *key, int key_len)
 {
-   cache_entry_list_t *iter = NULL;
+   cache_entry_t *entry = NULL;
    ENTRY;
 
-   LL_SEARCH (cache, iter, id, cache_cmp);
-   RETURN (iter);
+   HASH_FIND (hh, cache, key, (unsigned) key_len, entry);
+   RETURN (entry);
 }
 
 #define REPLACE_ASN1_TIME(_old, _new)                                 \
@@ -68,7 +83,7 @@ get_cache_entry (OCSP_CERTID *id)
    } while (0)
 
 static void
-update_entry (cache_entry_list_t *entry,
+update_entry (cache_entry_t *entry,
               int cert_status,
               int reason,
               ASN1_GENERALIZEDTIME *this_update,
@@ -100,47 +115,110 @@ _cmp_time (ASN1_TIME *a, ASN1_TIME *b)
 }
 #endif
 
+static bool
+is_expired (const cache_entry_t *entry)
+{
+   return entry->this_update && entry->next_update &&
+          !OCSP_check_validity (entry->this_update, entry->next_update, 0L, -1L);
+}
+
+static void
+cache_entry_destroy (cache_entry_t *entry)
+{
+   OPENSSL_free (entry->key);
+   OCSP_CERTID_free (entry->id);
+   ASN1_GENERALIZEDTIME_free (entry->this_update);
+   ASN1_GENERALIZEDTIME_free (entry->next_update);
+   bson_free (entry);
+}
+
+/* Remove every expired entry. Caller must hold ocsp_cache_mutex in exclusive
+ * mode. */
+static void
+remove_expired_entries (void)
+{
+   cache_entry_t *entry, *tmp;
+
+   HASH_ITER (hh, cache, entry, tmp)
+   {
+      if (is_expired (entry)) {
+         HASH_DEL (cache, entry);
+         cache_entry_destroy (entry);
+      }
+   }
+}
+
 void
 _mongoc_ocsp_cache_set_resp (
    OCSP_CERTID *id, int cert_status, int reason, ASN1_GENERALIZEDTIME *this_update, ASN1_GENERALIZEDTIME *next_update)
 {
-   cache_entry_list_t *entry = NULL;
+   cache_entry_t *entry = NULL;
+   unsigned char *key;
+   int key_len;
+   bool fresher = true;
    ENTRY;
 
-   bson_mutex_lock (&ocsp_cache_mutex);
-   if (!(entry = get_cache_entry (id))) {
-      entry = bson_malloc0 (sizeof (cache_entry_list_t));
+   if (!(key = encode_id (id, &key_len))) {
+      MONGOC_WARNING ("Could not encode OCSP_CERTID, not caching response");
+      EXIT;
+   }
+
+   /* Most calls re-cache a response that is already present; detect those
+    * without blocking concurrent lookups. */
+   bson_shared_mutex_lock_shared (&ocsp_cache_mutex);
+   if ((entry = get_cache_entry (key, key_len))) {
+      fresher = next_update && _cmp_time (next_update, entry->next_update) == 1;
+   }
+   bson_shared_mutex_unlock_shared (&ocsp_cache_mutex);
+
+   if (!fresher) {
+      /* Do nothing; our next_update is at a later date */
+      OPENSSL_free (key);
+      EXIT;
+   }
+
+   bson_shared_mutex_lock (&ocsp_cache_mutex);
+   if (!(entry = get_cache_entry (key, key_len))) {
+      /* Expired responses are never returned, so drop them before the table
+       * grows rather than waiting for their certificate to be seen again. */
+      remove_expired_entries ();
+
+      entry = bson_malloc0 (sizeof (cache_entry_t));
+      entry->key = key;
+      entry->key_len = key_len;
       entry->id = OCSP_CERTID_dup (id);
-      LL_APPEND (cache, entry);
+      HASH_ADD_KEYPTR (hh, cache, entry->key, (unsigned) entry->key_len, entry);
       update_entry (entry, cert_status, reason, this_update, next_update);
+      key = NULL;
    } else if (next_update && _cmp_time (next_update, entry->next_update) == 1) {
       update_entry (entry, cert_status, reason, this_update, next_update);
    } else {
-      /* Do nothing; our next_update is at a later date */
+      /* Do nothing; another thread cached a response with a later
+       * next_update */
    }
-   bson_mutex_unlock (&ocsp_cache_mutex);
+   bson_shared_mutex_unlock (&ocsp_cache_mutex);
+
+   OPENSSL_free (key);
+   EXIT;
 }
 
 int
 _mongoc_ocsp_cache_length (void)
 {
-   cache_entry_list_t *iter;
    int counter;
 
-   bson_mutex_lock (&ocsp_cache_mutex);
-   LL_COUNT (cache, iter, counter);
-   bson_mutex_unlock (&ocsp_cache_mutex);
+   bson_shared_mutex_lock_shared (&ocsp_cache_mutex);
+   counter = (int) HASH_COUNT (cache);
+   bson_shared_mutex_unlock_shared (&ocsp_cache_mutex);
    RETURN (counter);
 }
 
-static void
-cache_entry_destroy (cache_entry_list_t *entry)
+static ASN1_GENERALIZEDTIME *
+dup_time (ASN1_GENERALIZEDTIME *time)
 {
-   OCSP_CERTID_free (entry->id);
-   ASN1_GENERALIZEDTIME_free (entry->this_update);
-   ASN1_GENERALIZEDTIME_free (entry->next_update);
-   bson_free (entry);
+   return time ? ASN1_item_dup (ASN1_ITEM_rptr (ASN1_TIME), time) : NULL;
 }
+
 bool
 _mongoc_ocsp_cache_get_status (OCSP_CERTID *id,
                                int *cert_status,
@@ -148,19 +226,24 @@ _mongoc_ocsp_cache_get_status (OCSP_CERTID *id,
                                ASN1_GENERALIZEDTIME **this_update,
                                ASN1_GENERALIZEDTIME **next_update)
 {
-   cache_entry_list_t *entry = NULL;
+   cache_entry_t *entry = NULL;
+   unsigned char *key;
+   int key_len;
    bool ret = false;
+   bool expired = false;
    ENTRY;
 
-   bson_mutex_lock (&ocsp_cache_mutex);
-   if (!(entry = get_cache_entry (id))) {
+   if (!(key = encode_id (id, &key_len))) {
+      RETURN (false);
+   }
+
+   bson_shared_mutex_lock_shared (&ocsp_cache_mutex);
+   if (!(entry = get_cache_entry (key, key_len))) {
       GOTO (done);
    }
 
-   if (entry->this_update && entry->next_update &&
-       !OCSP_check_validity (entry->this_update, entry->next_update, 0L, -1L)) {
-      LL_DELETE (cache, entry);
-      cache_entry_destroy (entry);
+   if (is_expired (entry)) {
+      expired = true;
       GOTO (done);
    }
 
@@ -169,33 +252,47 @@ _mongoc_ocsp_cache_get_status (OCSP_CERTID *id,
    BSON_ASSERT_PARAM (this_update);
    BSON_ASSERT_PARAM (next_update);
 
+   /* The entry may be replaced once the lock is released, so return copies. */
    *cert_status = entry->cert_status;
    *reason = entry->reason;
-   *this_update = entry->this_update;
-   *next_update = entry->next_update;
+   *this_update = dup_time (entry->this_update);
+   *next_update = dup_time (entry->next_update);
 
    ret = true;
 done:
-   bson_mutex_unlock (&ocsp_cache_mutex);
+   bson_shared_mutex_unlock_shared (&ocsp_cache_mutex);
+
+   if (expired) {
+      /* Look the entry up again: another thread may have removed or refreshed
+       * it while no lock was held. */
+      bson_shared_mutex_lock (&ocsp_cache_mutex);
+      if ((entry = get_cache_entry (key, key_len)) && is_expired (entry)) {
+         HASH_DEL (cache, entry);
+         cache_entry_destroy (entry);
+      }
+      bson_shared_mutex_unlock (&ocsp_cache_mutex);
+   }
+
+   OPENSSL_free (key);
    RETURN (ret);
 }
 
 void
 _mongoc_ocsp_cache_cleanup (void)
 {
-   cache_entry_list_t *iter = NULL;
-   cache_entry_list_t *next = NULL;
+   cache_entry_t *entry, *tmp;
    ENTRY;
 
-   bson_mutex_lock (&ocsp_cache_mutex);
-   for (iter = cache; iter != NULL; iter = next) {
-      next = iter->next;
-      cache_entry_destroy (iter);
+   bson_shared_mutex_lock (&ocsp_cache_mutex);
+   HASH_ITER (hh, cache, entry, tmp)
+   {
+      HASH_DEL (cache, entry);
+      cache_entry_destroy (entry);
    }
 
    cache = NULL;
-   bson_mutex_unlock (&ocsp_cache_mutex);
-   bson_mutex_destroy (&ocsp_cache_mutex);
+   bson_shared_mutex_unlock (&ocsp_cache_mutex);
+   bson_shared_mutex_destroy (&ocsp_cache_mutex);
 }
 
 #endif /* MONGOC_ENABLE_OCSP_OPENSSL */
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2024-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mongoc-prelude.h"
+
+#ifndef MONGOC_OPENSSL_SESSION_CACHE_PRIVATE_H
+#define MONGOC_OPENSSL_SESSION_CACHE_PRIVATE_H
+
+#include "mongoc-config.h"
+
+#ifdef MONGOC_ENABLE_SSL_OPENSSL
+#include <openssl/ssl.h>
+
+#include "mongoc-ssl.h"
+
+/* SSL_SESSION_is_resumable was added in OpenSSL 1.1.1. */
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L && !defined(LIBRESSL_VERSION_NUMBER)
+#define MONGOC_ENABLE_OPENSSL_SESSION_CACHE
+#endif
+
+#ifdef MONGOC_ENABLE_OPENSSL_SESSION_CACHE
+
+/* Maximum number of TLS sessions kept for resumption. Once full, the least
+ * recently stored session is dropped. */
+#ifndef MONGOC_OPENSSL_SESSION_CACHE_SIZE
+#define MONGOC_OPENSSL_SESSION_CACHE_SIZE 256
+#endif
+
+void
+_mongoc_openssl_session_cache_init (void);
+
+/* Returns a key identifying the server at "host" and "port" and every TLS
+ * option that affects how its certificate was verified, so a session is only
+ * resumed by connections to that server that would have verified it the same
+ * way. "port" is 0 if unknown. Free with bson_free. */
+char *
+_mongoc_openssl_session_cache_key (const char *host, uint16_t port, const mongoc_ssl_opt_t *opt);
+
+/* Store new client sessions created with "ctx" in the cache. */
+void
+_mongoc_openssl_session_cache_install (SSL_CTX *ctx);
+
+/* Offer the cached session for "key", if any, when "ssl" connects. Sessions
+ * the server issues on "ssl" are stored under "key", which must outlive
+ * "ssl". */
+void
+_mongoc_openssl_session_cache_attach (SSL *ssl, const char *key);
+
+void
+_mongoc_openssl_session_cache_remove (const char *key);
+
+size_t
+_mongoc_openssl_session_cache_length (void);
+
+void
+_mongoc_openssl_session_cache_cleanup (void);
+
+#endif /* MONGOC_ENABLE_OPENSSL_SESSION_CACHE */
+#endif /* MONGOC_ENABLE_SSL_OPENSSL */
+
+/* ensure the translation unit is not empty */
+extern int no_mongoc_openssl_session_cache;
+#endif /* MONGOC_OPENSSL_SESSION_CACHE_PRIVATE_H */
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2024-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-openssl-session-cache-private.h"
+#ifdef MONGOC_ENABLE_OPENSSL_SESSION_CACHE
+
+#include "uthash.h"
+#include "mongoc-ssl-private.h"
+#include "mongoc-trace-private.h"
+#include <bson/bson.h>
+#include <common-thread-private.h>
+
+#undef MONGOC_LOG_DOMAIN
+#define MONGOC_LOG_DOMAIN "openssl-session-cache"
+
+/* Every connection creates its own SSL_CTX, so OpenSSL's per-context session
+ * cache never sees a second connection to the same server. Sessions are kept
+ * here instead, shared by every client, pool and monitor in the process, so
+ * reconnecting to a server can use an abbreviated handshake. */
+typedef struct {
+   char *key;
+   SSL_SESSION *session;
+   UT_hash_handle hh;
+} session_entry_t;
+
+/* Entries are kept in insertion order, oldest first. */
+static session_entry_t *cache;
+static bson_mutex_t session_cache_mutex;
+
+/* Index of the SSL ex_data slot holding the key a connection's sessions are
+ * stored under. */
+static int session_key_index = -1;
+
+void
+_mongoc_openssl_session_cache_init (void)
+{
+   bson_mutex_init (&session_cache_mutex);
+   if (session_key_index < 0) {
+      session_key_index = SSL_get_ex_new_index (0, NULL, NULL, NULL, NULL);
+   }
+}
+
+char *
+_mongoc_openssl_session_cache_key (const char *host, uint16_t port, const mongoc_ssl_opt_t *opt)
+{
+   BSON_ASSERT_PARAM (host);
+   BSON_ASSERT_PARAM (opt);
+
+   return bson_strdup_printf ("%s:%" PRIu16 "\n%s\n%s\n%s\n%s\n%d%d%d%d",
+                              host,
+                              port,
+                              opt->pem_file ? opt->pem_file : "",
+                              opt->ca_file ? opt->ca_file : "",
+                              opt->ca_dir ? opt->ca_dir : "",
+                              opt->crl_file ? opt->crl_file : "",
+                              (int) opt->weak_cert_validation,
+                              (int) opt->allow_invalid_hostname,
+                              (int) _mongoc_ssl_opts_disable_certificate_revocation_check (opt),
+                              (int) _mongoc_ssl_opts_disable_ocsp_endpoint_check (opt));
+}
+
+static void
+session_entry_destroy (session_entry_t *entry)
+{
+   SSL_SESSION_free (entry->session);
+   bson_free (entry->key);
+   bson_free (entry);
+}
+
+static bool
+is_expired (const SSL_SESSION *session)
+{
+   return (int64_t) SSL_SESSION_get_time (session) + (int64_t) SSL_SESSION_get_timeout (session) <=
+          (int64_t) time (NULL);
+}
+
+/* Called by OpenSSL when the server issues a session, which for TLS 1.3 may
+ * be after the handshake completes. Returning 1 takes the reference to
+ * "session". */
+static int
+_new_session_cb (SSL *ssl, SSL_SESSION *session)
+{
+   const char *key;
+   session_entry_t *entry;
+
+   key = SSL_get_ex_data (ssl, session_key_index);
+   if (!key || !SSL_SESSION_is_resumable (session)) {
+      return 0;
+   }
+
+   bson_mutex_lock (&session_cache_mutex);
+   HASH_FIND_STR (cache, key, entry);
+   if (entry) {
+      /* Re-add so the entry moves to the end of the eviction order. */
+      HASH_DEL (cache, entry);
+      SSL_SESSION_free (entry->session);
+   } else {
+      if (HASH_COUNT (cache) >= MONGOC_OPENSSL_SESSION_CACHE_SIZE) {
+         session_entry_t *oldest = cache;
+
+         HASH_DEL (cache, oldest);
+         session_entry_destroy (oldest);
+      }
+
+      entry = bson_malloc0 (sizeof *entry);
+      entry->key = bson_strdup (key);
+   }
+
+   entry->session = session;
+   HASH_ADD_KEYPTR (hh, cache, entry->key, strlen (entry->key), entry);
+   bson_mutex_unlock (&session_cache_mutex);
+
+   return 1;
+}
+
+void
+_mongoc_openssl_session_cache_install (SSL_CTX *ctx)
+{
+   BSON_ASSERT_PARAM (ctx);
+
+   SSL_CTX_set_session_cache_mode (ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+   SSL_CTX_sess_set_new_cb (ctx, _new_session_cb);
+}
+
+void
+_mongoc_openssl_session_cache_attach (SSL *ssl, const char *key)
+{
+   session_entry_t *entry;
+   ENTRY;
+
+   BSON_ASSERT_PARAM (ssl);
+   BSON_ASSERT_PARAM (key);
+
+   SSL_set_ex_data (ssl, session_key_index, (void *) key);
+
+   bson_mutex_lock (&session_cache_mutex);
+   HASH_FIND_STR (cache, key, entry);
+   if (entry) {
+      if (is_expired (entry->session)) {
+         HASH_DEL (cache, entry);
+         session_entry_destroy (entry);
+      } else if (!SSL_set_session (ssl, entry->session)) {
+         /* Not fatal: the handshake falls back to a full handshake. */
+         TRACE ("%s", "Could not set cached TLS session");
+      }
+   }
+   bson_mutex_unlock (&session_cache_mutex);
+
+   EXIT;
+}
+
+void
+_mongoc_openssl_session_cache_remove (const char *key)
+{
+   session_entry_t *entry;
+
+   BSON_ASSERT_PARAM (key);
+
+   bson_mutex_lock (&session_cache_mutex);
+   HASH_FIND_STR (cache, key, entry);
+   if (entry) {
+      HASH_DEL (cache, entry);
+      session_entry_destroy (entry);
+   }
+   bson_mutex_unlock (&session_cache_mutex);
+}
+
+size_t
+_mongoc_openssl_session_cache_length (void)
+{
+   size_t length;
+
+   bson_mutex_lock (&session_cache_mutex);
+   length = HASH_COUNT (cache);
+   bson_mutex_unlock (&session_cache_mutex);
+
+   return length;
+}
+
+void
+_mongoc_openssl_session_cache_cleanup (void)
+{
+   session_entry_t *entry, *tmp;
+
+   bson_mutex_lock (&session_cache_mutex);
+   HASH_ITER (hh, cache, entry, tmp)
+   {
+      HASH_DEL (cache, entry);
+      session_entry_destroy (entry);
+   }
+   cache = NULL;
+   bson_mutex_unlock (&session_cache_mutex);
+   bson_mutex_destroy (&session_cache_mutex);
+}
+
+#endif /* MONGOC_ENABLE_OPENSSL_SESSION_CACHE */
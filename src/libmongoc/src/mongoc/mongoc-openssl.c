@@ -732,6 +732,7 @@ _mongoc_ocsp_tlsext_status (SSL *ssl, mongoc_openssl_ocsp_opt_t *opts)
 {
    enum { OCSP_CB_ERROR = -1, OCSP_CB_REVOKED, OCSP_CB_SUCCESS } ret;
    bool stapled_response = true;
+   bool cached = false;
    bool must_staple;
    OCSP_RESPONSE *resp = NULL;
    OCSP_BASICRESP *basic = NULL;
@@ -776,6 +777,7 @@ _mongoc_ocsp_tlsext_status (SSL *ssl, mongoc_openssl_ocsp_opt_t *opts)
    }
 
    if (_mongoc_ocsp_cache_get_status (id, &cert_status, &reason, &this_update, &next_update)) {
+      cached = true;
       GOTO (validate);
    }
 
@@ -869,13 +871,17 @@ validate:
    switch (cert_status) {
    case V_OCSP_CERTSTATUS_GOOD:
       TRACE ("%s", "OCSP Certificate Status: Good");
-      _mongoc_ocsp_cache_set_resp (id, cert_status, reason, this_update, next_update);
+      if (!cached) {
+         _mongoc_ocsp_cache_set_resp (id, cert_status, reason, this_update, next_update);
+      }
       break;
 
    case V_OCSP_CERTSTATUS_REVOKED:
       MONGOC_ERROR ("OCSP Certificate Status: Revoked. Reason: %s", OCSP_crl_reason_str (reason));
       ret = OCSP_CB_REVOKED;
-      _mongoc_ocsp_cache_set_resp (id, cert_status, reason, this_update, next_update);
+      if (!cached) {
+         _mongoc_ocsp_cache_set_resp (id, cert_status, reason, this_update, next_update);
+      }
       GOTO (done);
 
    default:
@@ -894,6 +900,10 @@ done:
    if (ret == OCSP_CB_ERROR && !stapled_response) {
       ret = OCSP_CB_SUCCESS;
    }
+   if (cached) {
+      ASN1_GENERALIZEDTIME_free (this_update);
+      ASN1_GENERALIZEDTIME_free (next_update);
+   }
    if (basic)
       OCSP_BASICRESP_free (basic);
    if (resp)
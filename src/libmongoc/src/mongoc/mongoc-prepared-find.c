@@ -0,0 +1,111 @@
+/*
+ * Copyright 2024-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mongoc-prepared-find.h"
+#include "mongoc-collection-private.h"
+#include "mongoc-cursor-private.h"
+
+
+struct _mongoc_prepared_find_t {
+   /* a find cursor with an empty filter that is never iterated. It holds the
+    * validated opts, read preference, read concern, and session. */
+   mongoc_cursor_t *cursor;
+};
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_collection_prepare_find --
+ *
+ *       Validate @opts and resolve the read preference and read concern
+ *       of a find operation once, for repeated calls to
+ *       mongoc_prepared_find_execute.
+ *
+ * Returns:
+ *       A mongoc_prepared_find_t to be freed with
+ *       mongoc_prepared_find_destroy, or NULL and @error is set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_prepared_find_t *
+mongoc_collection_prepare_find (mongoc_collection_t *collection,
+                                const bson_t *opts,
+                                const mongoc_read_prefs_t *read_prefs,
+                                bson_error_t *error)
+{
+   mongoc_prepared_find_t *prepared;
+   mongoc_cursor_t *cursor;
+
+   BSON_ASSERT_PARAM (collection);
+
+   cursor = _mongoc_cursor_find_new (collection->client,
+                                     collection->ns,
+                                     NULL /* filter */,
+                                     opts,
+                                     read_prefs,
+                                     collection->read_prefs,
+                                     collection->read_concern);
+
+   if (mongoc_cursor_error (cursor, error)) {
+      mongoc_cursor_destroy (cursor);
+      return NULL;
+   }
+
+   prepared = BSON_ALIGNED_ALLOC0 (mongoc_prepared_find_t);
+   prepared->cursor = cursor;
+
+   return prepared;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * mongoc_prepared_find_execute --
+ *
+ *       Create a cursor for a find operation with @filter and the
+ *       options of @prepared. Unlike mongoc_collection_find_with_opts,
+ *       the options are copied rather than parsed again.
+ *
+ * Returns:
+ *       A mongoc_cursor_t to be freed with mongoc_cursor_destroy.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+mongoc_cursor_t *
+mongoc_prepared_find_execute (const mongoc_prepared_find_t *prepared, const bson_t *filter)
+{
+   BSON_ASSERT_PARAM (prepared);
+   BSON_ASSERT_PARAM (filter);
+
+   return _mongoc_cursor_find_new_from_prepared (prepared->cursor, filter);
+}
+
+
+void
+mongoc_prepared_find_destroy (mongoc_prepared_find_t *prepared)
+{
+   if (!prepared) {
+      return;
+   }
+
+   mongoc_cursor_destroy (prepared->cursor);
+   bson_free (prepared);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2024-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mongoc-prelude.h"
+
+#ifndef MONGOC_PREPARED_FIND_H
+#define MONGOC_PREPARED_FIND_H
+
+#include <bson/bson.h>
+
+#include "mongoc-macros.h"
+#include "mongoc-collection.h"
+#include "mongoc-cursor.h"
+#include "mongoc-read-prefs.h"
+
+BSON_BEGIN_DECLS
+
+typedef struct _mongoc_prepared_find_t mongoc_prepared_find_t;
+
+MONGOC_EXPORT (mongoc_prepared_find_t *)
+mongoc_collection_prepare_find (mongoc_collection_t *collection,
+                                const bson_t *opts,
+                                const mongoc_read_prefs_t *read_prefs,
+                                bson_error_t *error) BSON_GNUC_WARN_UNUSED_RESULT;
+
+MONGOC_EXPORT (mongoc_cursor_t *)
+mongoc_prepared_find_execute (const mongoc_prepared_find_t *prepared, const bson_t *filter)
+   BSON_GNUC_WARN_UNUSED_RESULT;
+
+MONGOC_EXPORT (void)
+mongoc_prepared_find_destroy (mongoc_prepared_find_t *prepared);
+
+BSON_END_DECLS
+
+
+#endif /* MONGOC_PREPARED_FIND_H */
@@ -37,11 +37,15 @@ BSON_BEGIN_DECLS
 
 #define MONGOC_SCRAM_B64_HASH_MAX_SIZE MONGOC_SCRAM_B64_ENCODED_SIZE (MONGOC_SCRAM_HASH_MAX_SIZE)
 
-enum {
-   /* It is unlikely that there will be more than 64 different user accounts
-    * used in a single process */
-   MONGOC_SCRAM_CACHE_SIZE = 64,
-};
+/* The number of salted passwords cached per process. A process may connect
+ * as many different users, e.g. one per tenant. Define it at build time to
+ * change it. */
+#ifndef MONGOC_SCRAM_CACHE_SIZE
+#define MONGOC_SCRAM_CACHE_SIZE 1024
+#endif
+
+/* The cache is split into shards, each with its own lock. */
+#define MONGOC_SCRAM_CACHE_SHARDS 16
 
 typedef struct _mongoc_scram_t {
    int step;
@@ -83,6 +87,18 @@ _mongoc_scram_set_salted_password (mongoc_scram_t *scram, const uint8_t *salted_
 void
 _mongoc_scram_destroy (mongoc_scram_t *scram);
 
+#ifdef MONGOC_ENABLE_CRYPTO
+/* Set the number of salted passwords cached, or restore the default with
+ * MONGOC_SCRAM_CACHE_SIZE. Must not be called while authenticating.
+ * _mongoc_scram_cache_set_capacity is exposed for testing. */
+void
+_mongoc_scram_cache_set_capacity (size_t capacity);
+
+/* Free all cached salted passwords. */
+void
+_mongoc_scram_cache_clear (void);
+#endif
+
 bool
 _mongoc_scram_step (mongoc_scram_t *scram,
                     const uint8_t *inbuf,
@@ -30,21 +30,31 @@
 
 #include "mongoc-memcmp-private.h"
 #include "common-thread-private.h"
+#include "uthash.h"
 #include <utf8proc.h>
 
-typedef struct _mongoc_scram_cache_entry_t {
-   /* book keeping */
-   bool taken;
-   /* pre-secrets */
+/* The pre-secrets, compared byte for byte. Unused bytes are zero. */
+typedef struct _mongoc_scram_cache_key_t {
    char hashed_password[MONGOC_SCRAM_HASH_MAX_SIZE];
    uint8_t decoded_salt[MONGOC_SCRAM_B64_HASH_MAX_SIZE];
    uint32_t iterations;
+} mongoc_scram_cache_key_t;
+
+typedef struct _mongoc_scram_cache_entry_t {
+   mongoc_scram_cache_key_t key; // Hash key.
    /* secrets */
    uint8_t client_key[MONGOC_SCRAM_HASH_MAX_SIZE];
    uint8_t server_key[MONGOC_SCRAM_HASH_MAX_SIZE];
    uint8_t salted_password[MONGOC_SCRAM_HASH_MAX_SIZE];
+   UT_hash_handle hh;
 } mongoc_scram_cache_entry_t;
 
+typedef struct _mongoc_scram_cache_shard_t {
+   bson_mutex_t lock;
+   /* a hash table, in order from least to most recently used */
+   mongoc_scram_cache_entry_t *entries;
+} mongoc_scram_cache_shard_t;
+
 #define MONGOC_SCRAM_SERVER_KEY "Server Key"
 #define MONGOC_SCRAM_CLIENT_KEY "Client Key"
 
@@ -74,34 +84,24 @@ _mongoc_utf8_code_point_length (uint32_t c);
 ssize_t
 _mongoc_utf8_code_point_to_str (uint32_t c, char *out);
 
-static bson_shared_mutex_t g_scram_cache_rwlock;
-
 static bson_once_t init_cache_once_control = BSON_ONCE_INIT;
-static bson_mutex_t clear_cache_lock;
 
 /*
- * Cache lookups are a linear search through this table. This table is a
- * constant size, which is small enough that lookup cost is insignificant.
- *
- * This can be refactored into a hashmap if the cache size needs to grow larger
- * in the future, but a linear lookup is currently fast enough and is much
- * simpler logic to reason about.
+ * Each user's pre-secrets hash to one shard, which is a hash table with its
+ * own lock, so that threads authenticating as different users rarely
+ * contend. A full shard evicts its least recently used entry.
  */
-static mongoc_scram_cache_entry_t g_scram_cache[MONGOC_SCRAM_CACHE_SIZE];
+static mongoc_scram_cache_shard_t g_scram_cache[MONGOC_SCRAM_CACHE_SHARDS];
 
-static void
-_mongoc_scram_cache_clear (void)
-{
-   bson_mutex_lock (&clear_cache_lock);
-   memset (g_scram_cache, 0, sizeof (g_scram_cache));
-   bson_mutex_unlock (&clear_cache_lock);
-}
+/* the most entries in each shard */
+static size_t g_scram_cache_shard_capacity = MONGOC_SCRAM_CACHE_SIZE / MONGOC_SCRAM_CACHE_SHARDS;
 
 static BSON_ONCE_FUN (_mongoc_scram_cache_init)
 {
-   bson_shared_mutex_init (&g_scram_cache_rwlock);
-   bson_mutex_init (&clear_cache_lock);
-   _mongoc_scram_cache_clear ();
+   for (size_t i = 0; i < MONGOC_SCRAM_CACHE_SHARDS; i++) {
+      bson_mutex_init (&g_scram_cache[i].lock);
+      g_scram_cache[i].entries = NULL;
+   }
 
    BSON_ONCE_RETURN;
 }
@@ -112,6 +112,55 @@ _mongoc_scram_cache_init_once (void)
    bson_once (&init_cache_once_control, _mongoc_scram_cache_init);
 }
 
+static void
+_mongoc_scram_cache_entry_destroy (mongoc_scram_cache_entry_t *entry)
+{
+   bson_zero_free (entry, sizeof *entry);
+}
+
+void
+_mongoc_scram_cache_clear (void)
+{
+   _mongoc_scram_cache_init_once ();
+
+   for (size_t i = 0; i < MONGOC_SCRAM_CACHE_SHARDS; i++) {
+      mongoc_scram_cache_shard_t *shard = &g_scram_cache[i];
+      mongoc_scram_cache_entry_t *entry, *tmp;
+
+      bson_mutex_lock (&shard->lock);
+      HASH_ITER (hh, shard->entries, entry, tmp)
+      {
+         HASH_DEL (shard->entries, entry);
+         _mongoc_scram_cache_entry_destroy (entry);
+      }
+      bson_mutex_unlock (&shard->lock);
+   }
+}
+
+void
+_mongoc_scram_cache_set_capacity (size_t capacity)
+{
+   g_scram_cache_shard_capacity = BSON_MAX (capacity / MONGOC_SCRAM_CACHE_SHARDS, 1u);
+   _mongoc_scram_cache_clear ();
+}
+
+/* Returns the shard for scram's pre-secrets, and sets `key` and `hashv`. */
+static mongoc_scram_cache_shard_t *
+_mongoc_scram_cache_shard (const mongoc_scram_t *scram, mongoc_scram_cache_key_t *key, unsigned *hashv)
+{
+   _mongoc_scram_cache_init_once ();
+
+   memset (key, 0, sizeof *key);
+   bson_strncpy (key->hashed_password, scram->hashed_password, sizeof (key->hashed_password));
+   memcpy (key->decoded_salt, scram->decoded_salt, sizeof (key->decoded_salt));
+   key->iterations = scram->iterations;
+
+   HASH_VALUE (key, sizeof *key, *hashv);
+
+   /* uthash picks buckets by the low bits, so pick shards by high bits */
+   return &g_scram_cache[(*hashv >> 16) % MONGOC_SCRAM_CACHE_SHARDS];
+}
+
 static int
 _scram_hash_size (mongoc_scram_t *scram)
 {
@@ -151,41 +200,34 @@ _mongoc_scram_cache_destroy (mongoc_scram_cache_entry_t *cache)
 static bool
 _mongoc_scram_cache_has_presecrets (mongoc_scram_cache_entry_t *cache /* out */, const mongoc_scram_t *scram)
 {
-   bool cache_hit = false;
+   mongoc_scram_cache_shard_t *shard;
+   mongoc_scram_cache_entry_t *cache_entry;
+   mongoc_scram_cache_key_t key;
+   unsigned hashv;
 
    BSON_ASSERT (cache);
    BSON_ASSERT (scram);
 
-   _mongoc_scram_cache_init_once ();
+   shard = _mongoc_scram_cache_shard (scram, &key, &hashv);
 
-   /*
-    * - Take a read lock
-    * - Search through g_scram_cache if the hashed_password, decoded_salt, and
-    *   iterations match an entry.
-    * - If so, then return true
-    * - Otherwise return false
-    */
-   bson_shared_mutex_lock_shared (&g_scram_cache_rwlock);
-
-   for (size_t i = 0; i < MONGOC_SCRAM_CACHE_SIZE; i++) {
-      if (g_scram_cache[i].taken) {
-         mongoc_scram_cache_entry_t *cache_entry = &g_scram_cache[i];
-         cache_hit = !strcmp (cache_entry->hashed_password, scram->hashed_password) &&
-                     cache_entry->iterations == scram->iterations &&
-                     !memcmp (cache_entry->decoded_salt, scram->decoded_salt, sizeof (cache_entry->decoded_salt));
-         if (cache_hit) {
-            /* copy the found cache items into the 'cache' output parameter */
-            memcpy (cache->client_key, cache_entry->client_key, sizeof (cache->client_key));
-            memcpy (cache->server_key, cache_entry->server_key, sizeof (cache->server_key));
-            memcpy (cache->salted_password, cache_entry->salted_password, sizeof (cache->salted_password));
-            goto done;
-         }
-      }
+   bson_mutex_lock (&shard->lock);
+
+   HASH_FIND_BYHASHVALUE (hh, shard->entries, &key, sizeof key, hashv, cache_entry);
+   if (cache_entry) {
+      /* copy the found cache items into the 'cache' output parameter */
+      memcpy (cache->client_key, cache_entry->client_key, sizeof (cache->client_key));
+      memcpy (cache->server_key, cache_entry->server_key, sizeof (cache->server_key));
+      memcpy (cache->salted_password, cache_entry->salted_password, sizeof (cache->salted_password));
+
+      /* move it to the end, as the most recently used */
+      HASH_DELETE (hh, shard->entries, cache_entry);
+      HASH_ADD_KEYPTR_BYHASHVALUE (hh, shard->entries, &cache_entry->key, sizeof cache_entry->key, hashv, cache_entry);
    }
 
-done:
-   bson_shared_mutex_unlock_shared (&g_scram_cache_rwlock);
-   return cache_hit;
+   bson_mutex_unlock (&shard->lock);
+   memset (&key, 0, sizeof key);
+
+   return cache_entry != NULL;
 }
 
 
@@ -244,45 +286,38 @@ _mongoc_scram_destroy (mongoc_scram_t *scram)
 static void
 _mongoc_scram_cache_insert (const mongoc_scram_t *scram)
 {
-   bson_shared_mutex_lock (&g_scram_cache_rwlock);
-
-again:
-   for (size_t i = 0; i < MONGOC_SCRAM_CACHE_SIZE; i++) {
-      mongoc_scram_cache_entry_t *cache_entry = &g_scram_cache[i];
-      bool already_exists =
-         !strcmp (cache_entry->hashed_password, scram->hashed_password) &&
-         cache_entry->iterations == scram->iterations &&
-         !memcmp (cache_entry->decoded_salt, scram->decoded_salt, sizeof (cache_entry->decoded_salt)) &&
-         !memcmp (cache_entry->client_key, scram->client_key, sizeof (cache_entry->client_key)) &&
-         !memcmp (cache_entry->server_key, scram->server_key, sizeof (cache_entry->server_key)) &&
-         !memcmp (cache_entry->salted_password, scram->salted_password, sizeof (cache_entry->salted_password));
-
-      if (already_exists) {
-         /* cache entry already populated between read and write lock
-          * acquisition, skipping */
-         break;
-      }
+   mongoc_scram_cache_shard_t *shard;
+   mongoc_scram_cache_entry_t *cache_entry;
+   mongoc_scram_cache_key_t key;
+   unsigned hashv;
 
-      if (!cache_entry->taken) {
-         /* found an empty slot */
-         memcpy (cache_entry->client_key, scram->client_key, sizeof (cache_entry->client_key));
-         memcpy (cache_entry->server_key, scram->server_key, sizeof (cache_entry->server_key));
-         memcpy (cache_entry->salted_password, scram->salted_password, sizeof (cache_entry->salted_password));
-         memcpy (cache_entry->decoded_salt, scram->decoded_salt, sizeof (cache_entry->decoded_salt));
-         memcpy (cache_entry->hashed_password, scram->hashed_password, sizeof (cache_entry->hashed_password));
-         cache_entry->iterations = scram->iterations;
-         cache_entry->taken = true;
-         break;
-      }
+   shard = _mongoc_scram_cache_shard (scram, &key, &hashv);
 
-      /* if cache is full, then invalidate the cache and insert again */
-      if (i == (MONGOC_SCRAM_CACHE_SIZE - 1)) {
-         _mongoc_scram_cache_clear ();
-         goto again;
-      }
+   bson_mutex_lock (&shard->lock);
+
+   HASH_FIND_BYHASHVALUE (hh, shard->entries, &key, sizeof key, hashv, cache_entry);
+   if (cache_entry) {
+      /* cache entry already populated between lookup and insert, skipping */
+      goto done;
+   }
+
+   /* if the shard is full, evict the least recently used entry */
+   if (HASH_COUNT (shard->entries) >= g_scram_cache_shard_capacity) {
+      cache_entry = shard->entries;
+      HASH_DELETE (hh, shard->entries, cache_entry);
+      _mongoc_scram_cache_entry_destroy (cache_entry);
    }
 
-   bson_shared_mutex_unlock (&g_scram_cache_rwlock);
+   cache_entry = bson_malloc0 (sizeof *cache_entry);
+   cache_entry->key = key;
+   memcpy (cache_entry->client_key, scram->client_key, sizeof (cache_entry->client_key));
+   memcpy (cache_entry->server_key, scram->server_key, sizeof (cache_entry->server_key));
+   memcpy (cache_entry->salted_password, scram->salted_password, sizeof (cache_entry->salted_password));
+   HASH_ADD_KEYPTR_BYHASHVALUE (hh, shard->entries, &cache_entry->key, sizeof cache_entry->key, hashv, cache_entry);
+
+done:
+   bson_mutex_unlock (&shard->lock);
+   memset (&key, 0, sizeof key);
 }
 
 /* Updates the cache with scram's last-used pre-secrets and secrets */
@@ -1119,6 +1119,7 @@ static BSON_THREAD_FUN (_server_monitor_thread, server_monitor_void)
       }
 
       _update_topology_description (server_monitor, description);
+      _mongoc_topology_sweep_server_sessions (server_monitor->topology, false);
 
       /* Immediately proceed to the next check if the previous response was
        * successful and included the topologyVersion field. */
@@ -41,6 +41,9 @@ typedef struct _mongoc_server_stream_t {
    // by a network error establishing an initial connection. Used to avoid
    // further retry attempts.
    bool retry_attempted;
+   // True if the last reply read from this stream had the moreToCome flag: the
+   // server will send the next reply of an exhaust cursor without a request.
+   bool more_to_come;
 } mongoc_server_stream_t;
 
 
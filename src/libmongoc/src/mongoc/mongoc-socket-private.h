@@ -23,6 +23,13 @@
 
 BSON_BEGIN_DECLS
 
+/* Polling this many sockets or streams needs no heap allocation. The async
+ * scanner and single-stream waits stay below it for typical deployments. */
+#define MONGOC_SOCKET_POLL_PREALLOC 16
+
+/* Sending this many iovecs with mongoc_socket_sendv needs no heap allocation. */
+#define MONGOC_SOCKET_SENDV_PREALLOC 16
+
 struct _mongoc_socket_t {
 #ifdef _WIN32
    SOCKET sd;
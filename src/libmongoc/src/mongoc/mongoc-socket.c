@@ -286,6 +286,7 @@ mongoc_socket_poll (mongoc_socket_poll_t *sds, /* IN */
    fd_set error_fds;
    struct timeval timeout_tv;
 #else
+   struct pollfd pfds_prealloc[MONGOC_SOCKET_POLL_PREALLOC];
    struct pollfd *pfds;
 #endif
    int ret;
@@ -333,7 +334,11 @@ mongoc_socket_poll (mongoc_socket_poll_t *sds, /* IN */
       }
    }
 #else
-   pfds = (struct pollfd *) bson_malloc (sizeof (*pfds) * nsds);
+   if (nsds <= MONGOC_SOCKET_POLL_PREALLOC) {
+      pfds = pfds_prealloc;
+   } else {
+      pfds = (struct pollfd *) bson_malloc (sizeof (*pfds) * nsds);
+   }
 
    for (size_t i = 0u; i < nsds; i++) {
       pfds[i].fd = sds[i].socket->sd;
@@ -346,7 +351,9 @@ mongoc_socket_poll (mongoc_socket_poll_t *sds, /* IN */
       sds[i].revents = pfds[i].revents;
    }
 
-   bson_free (pfds);
+   if (pfds != pfds_prealloc) {
+      bson_free (pfds);
+   }
 #endif
 
    return ret;
@@ -1022,6 +1029,10 @@ fail:
  *       A portable wrapper around recv() that also respects an absolute
  *       timeout.
  *
+ *       The socket is non-blocking, so recv() is attempted first and the
+ *       socket is only polled if no data is available yet. A reply that
+ *       already arrived costs a single syscall.
+ *
  *       @expire_at is 0 for no blocking, -1 for infinite blocking,
  *       or a time using the monotonic clock to expire. Calculate this
  *       using bson_get_monotonic_time() + N_MICROSECONDS.
@@ -1337,6 +1348,7 @@ mongoc_socket_sendv (mongoc_socket_t *sock,  /* IN */
    ssize_t ret = 0;
    ssize_t sent;
    size_t cur = 0;
+   mongoc_iovec_t iov_prealloc[MONGOC_SOCKET_SENDV_PREALLOC];
    mongoc_iovec_t *iov;
 
    ENTRY;
@@ -1345,7 +1357,13 @@ mongoc_socket_sendv (mongoc_socket_t *sock,  /* IN */
    BSON_ASSERT (in_iov);
    BSON_ASSERT (iovcnt);
 
-   iov = bson_malloc (sizeof (*iov) * iovcnt);
+   /* The copy is consumed as bytes are sent. A message needs few iovecs, so
+    * avoid allocating for it. */
+   if (iovcnt <= MONGOC_SOCKET_SENDV_PREALLOC) {
+      iov = iov_prealloc;
+   } else {
+      iov = bson_malloc (sizeof (*iov) * iovcnt);
+   }
    memcpy (iov, in_iov, sizeof (*iov) * iovcnt);
 
    for (;;) {
@@ -1416,7 +1434,9 @@ mongoc_socket_sendv (mongoc_socket_t *sock,  /* IN */
    }
 
 CLEANUP:
-   bson_free (iov);
+   if (iov != iov_prealloc) {
+      bson_free (iov);
+   }
 
    RETURN (ret);
 }
@@ -200,6 +200,11 @@ mongoc_stream_buffered_writev (mongoc_stream_t *stream, /* IN */
  *       requested number of bytes, but try to also fill the stream to
  *       the size of the underlying buffer.
  *
+ *       If @min_bytes is nonzero and less than the requested number of
+ *       bytes, only @min_bytes must be available; whatever else is
+ *       buffered is returned as well, up to the requested number of
+ *       bytes.
+ *
  * Note:
  *       This isn't actually a huge savings since we never have more than
  *       one reply waiting for us, but perhaps someday that will be
@@ -225,35 +230,39 @@ mongoc_stream_buffered_readv (mongoc_stream_t *stream, /* IN */
    mongoc_stream_buffered_t *buffered = (mongoc_stream_buffered_t *) stream;
    bson_error_t error = {0};
    size_t total_bytes = 0;
+   size_t required_bytes;
+   size_t to_copy;
    size_t i;
    size_t off = 0;
 
    ENTRY;
 
-   BSON_UNUSED (min_bytes);
-
    BSON_ASSERT (buffered);
 
    for (i = 0; i < iovcnt; i++) {
       total_bytes += iov[i].iov_len;
    }
 
-   if (-1 == _mongoc_buffer_fill (&buffered->buffer, buffered->base_stream, total_bytes, timeout_msec, &error)) {
+   required_bytes = (min_bytes > 0u && min_bytes < total_bytes) ? min_bytes : total_bytes;
+
+   if (-1 == _mongoc_buffer_fill (&buffered->buffer, buffered->base_stream, required_bytes, timeout_msec, &error)) {
       MONGOC_WARNING ("%s", error.message);
       RETURN (-1);
    }
 
-   BSON_ASSERT (buffered->buffer.len >= total_bytes);
+   BSON_ASSERT (buffered->buffer.len >= required_bytes);
 
-   for (i = 0; i < iovcnt; i++) {
-      memcpy (iov[i].iov_base, buffered->buffer.data + off, iov[i].iov_len);
-      off += iov[i].iov_len;
-      buffered->buffer.len -= iov[i].iov_len;
+   for (i = 0; i < iovcnt && off < buffered->buffer.len; i++) {
+      to_copy = BSON_MIN (iov[i].iov_len, buffered->buffer.len - off);
+      memcpy (iov[i].iov_base, buffered->buffer.data + off, to_copy);
+      off += to_copy;
    }
 
+   buffered->buffer.len -= off;
+
    memmove (buffered->buffer.data, buffered->buffer.data + off, buffered->buffer.len);
 
-   RETURN (total_bytes);
+   RETURN ((ssize_t) off);
 }
 
 
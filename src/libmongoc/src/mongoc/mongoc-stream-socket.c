@@ -209,12 +209,17 @@ _mongoc_stream_socket_poll (mongoc_stream_poll_t *streams, size_t nstreams, int3
 
 {
    ssize_t ret = -1;
+   mongoc_socket_poll_t sds_prealloc[MONGOC_SOCKET_POLL_PREALLOC];
    mongoc_socket_poll_t *sds;
    mongoc_stream_socket_t *ss;
 
    ENTRY;
 
-   sds = (mongoc_socket_poll_t *) bson_malloc (sizeof (*sds) * nstreams);
+   if (nstreams <= MONGOC_SOCKET_POLL_PREALLOC) {
+      sds = sds_prealloc;
+   } else {
+      sds = (mongoc_socket_poll_t *) bson_malloc (sizeof (*sds) * nstreams);
+   }
 
    for (size_t i = 0u; i < nstreams; i++) {
       ss = (mongoc_stream_socket_t *) streams[i].stream;
@@ -236,7 +241,9 @@ _mongoc_stream_socket_poll (mongoc_stream_poll_t *streams, size_t nstreams, int3
    }
 
 CLEANUP:
-   bson_free (sds);
+   if (sds != sds_prealloc) {
+      bson_free (sds);
+   }
 
    RETURN (ret);
 }
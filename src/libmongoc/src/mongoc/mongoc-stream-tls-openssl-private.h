@@ -22,6 +22,9 @@
 #ifdef MONGOC_ENABLE_SSL_OPENSSL
 #include <bson/bson.h>
 
+#include "mongoc-ssl.h"
+#include "mongoc-stream.h"
+
 BSON_BEGIN_DECLS
 
 typedef struct {
@@ -47,8 +50,14 @@ typedef struct {
    BIO_METHOD *meth;
    SSL_CTX *ctx;
    mongoc_openssl_ocsp_opt_t *ocsp_opts;
+   /* Key this connection's TLS sessions are cached under, or NULL. */
+   char *session_key;
 } mongoc_stream_tls_openssl_t;
 
+mongoc_stream_t *
+_mongoc_stream_tls_openssl_new_with_port (
+   mongoc_stream_t *base_stream, const char *host, uint16_t port, mongoc_ssl_opt_t *opt, int client);
+
 
 BSON_END_DECLS
 
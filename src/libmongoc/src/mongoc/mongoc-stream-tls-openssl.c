@@ -37,6 +37,7 @@
 #include "mongoc-stream-tls-openssl-bio-private.h"
 #include "mongoc-stream-tls-openssl-private.h"
 #include "mongoc-openssl-private.h"
+#include "mongoc-openssl-session-cache-private.h"
 #include "mongoc-trace-private.h"
 #include "mongoc-log.h"
 #include "mongoc-error.h"
@@ -45,7 +46,15 @@
 #undef MONGOC_LOG_DOMAIN
 #define MONGOC_LOG_DOMAIN "stream-tls-openssl"
 
-#define MONGOC_STREAM_TLS_OPENSSL_BUFFER_SIZE 4096
+/* Size of the buffer used to coalesce small iovecs in writev. Defaults to the
+ * maximum TLS record payload so each flush fills a single record. */
+#ifndef MONGOC_STREAM_TLS_OPENSSL_BUFFER_SIZE
+#define MONGOC_STREAM_TLS_OPENSSL_BUFFER_SIZE 16384
+#endif
+
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L && !defined(LIBRESSL_VERSION_NUMBER)
+#define MONGOC_STREAM_TLS_OPENSSL_HAVE_WRITE_EX
+#endif
 
 #if OPENSSL_VERSION_NUMBER < 0x10100000L || (defined(LIBRESSL_VERSION_NUMBER) && LIBRESSL_VERSION_NUMBER < 0x20700000L)
 static void
@@ -97,6 +106,10 @@ _mongoc_stream_tls_openssl_destroy (mongoc_stream_t *stream)
    mongoc_openssl_ocsp_opt_destroy (openssl->ocsp_opts);
    openssl->ocsp_opts = NULL;
 
+   /* Freed after the SSL object, which refers to it. */
+   bson_free (openssl->session_key);
+   openssl->session_key = NULL;
+
    bson_free (openssl);
    bson_free (stream);
 
@@ -207,12 +220,45 @@ _mongoc_stream_tls_openssl_write (mongoc_stream_tls_t *tls, char *buf, size_t bu
       expire = bson_get_monotonic_time () + (tls->timeout_msec * 1000);
    }
 
+#ifdef MONGOC_STREAM_TLS_OPENSSL_HAVE_WRITE_EX
+   {
+      /* Write through the SSL object directly, as BIO_write is limited to int
+       * lengths. Maintain the ssl BIO's retry flags the way BIO_write would. */
+      SSL *ssl;
+      size_t written = 0u;
+      int ssl_ret;
+
+      BIO_get_ssl (openssl->bio, &ssl);
+      BIO_clear_retry_flags (openssl->bio);
+
+      ssl_ret = SSL_write_ex (ssl, buf, buf_len, &written);
+
+      if (ssl_ret <= 0) {
+         switch (SSL_get_error (ssl, ssl_ret)) {
+         case SSL_ERROR_WANT_WRITE:
+            BIO_set_retry_write (openssl->bio);
+            break;
+         case SSL_ERROR_WANT_READ:
+            BIO_set_retry_read (openssl->bio);
+            break;
+         default:
+            break;
+         }
+
+         return -1;
+      }
+
+      BSON_ASSERT (bson_in_range_unsigned (ssize_t, written));
+      ret = (ssize_t) written;
+   }
+#else
    BSON_ASSERT (bson_in_range_unsigned (int, buf_len));
    ret = BIO_write (openssl->bio, buf, (int) buf_len);
 
    if (ret <= 0) {
       return ret;
    }
+#endif
 
    if (expire) {
       now = bson_get_monotonic_time ();
@@ -545,6 +591,19 @@ _mongoc_stream_tls_openssl_set_verify_cert_error (SSL *ssl, bson_error_t *error)
    return true;
 }
 
+/* Do not offer a session from a connection that failed verification. */
+static void
+_mongoc_stream_tls_openssl_forget_session (mongoc_stream_tls_openssl_t *openssl)
+{
+#ifdef MONGOC_ENABLE_OPENSSL_SESSION_CACHE
+   if (openssl->session_key) {
+      _mongoc_openssl_session_cache_remove (openssl->session_key);
+   }
+#else
+   BSON_UNUSED (openssl);
+#endif
+}
+
 /**
  * mongoc_stream_tls_openssl_handshake:
  */
@@ -567,6 +626,7 @@ _mongoc_stream_tls_openssl_handshake (mongoc_stream_t *stream, const char *host,
 #ifdef MONGOC_ENABLE_OCSP_OPENSSL
       /* Validate OCSP */
       if (openssl->ocsp_opts && 1 != _mongoc_ocsp_tlsext_status (ssl, openssl->ocsp_opts)) {
+         _mongoc_stream_tls_openssl_forget_session (openssl);
          bson_set_error (
             error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_SOCKET, "TLS handshake failed: Failed OCSP verification");
          RETURN (false);
@@ -577,6 +637,8 @@ _mongoc_stream_tls_openssl_handshake (mongoc_stream_t *stream, const char *host,
          RETURN (true);
       }
 
+      _mongoc_stream_tls_openssl_forget_session (openssl);
+
       /* Try to relay certificate failure reason from OpenSSL library if any. */
       if (_mongoc_stream_tls_openssl_set_verify_cert_error (ssl, error)) {
          RETURN (false);
@@ -606,6 +668,8 @@ _mongoc_stream_tls_openssl_handshake (mongoc_stream_t *stream, const char *host,
 
    *events = 0;
 
+   _mongoc_stream_tls_openssl_forget_session (openssl);
+
    /* Try to relay certificate failure reason from OpenSSL library if any. */
    if (_mongoc_stream_tls_openssl_set_verify_cert_error (ssl, error)) {
       RETURN (false);
@@ -720,10 +784,20 @@ _mongoc_stream_tls_openssl_should_retry (mongoc_stream_t *stream)
 
 mongoc_stream_t *
 mongoc_stream_tls_openssl_new (mongoc_stream_t *base_stream, const char *host, mongoc_ssl_opt_t *opt, int client)
+{
+   return _mongoc_stream_tls_openssl_new_with_port (base_stream, host, 0, opt, client);
+}
+
+/* Like mongoc_stream_tls_openssl_new, for a connection to @port on @host, or
+ * 0 if unknown. TLS sessions are cached per host and port. */
+mongoc_stream_t *
+_mongoc_stream_tls_openssl_new_with_port (
+   mongoc_stream_t *base_stream, const char *host, uint16_t port, mongoc_ssl_opt_t *opt, int client)
 {
    mongoc_stream_tls_t *tls;
    mongoc_stream_tls_openssl_t *openssl;
    mongoc_openssl_ocsp_opt_t *ocsp_opts = NULL;
+   char *session_key = NULL;
    SSL_CTX *ssl_ctx = NULL;
    BIO *bio_ssl = NULL;
    BIO *bio_mongoc_shim = NULL;
@@ -822,11 +896,26 @@ mongoc_stream_tls_openssl_new (mongoc_stream_t *base_stream, const char *host, m
    }
 #endif /* MONGOC_ENABLE_OCSP_OPENSSL */
 
+#ifdef MONGOC_ENABLE_OPENSSL_SESSION_CACHE
+   if (client && host) {
+      SSL *ssl;
+
+      /* Resume a previous session with this server if possible, and keep the
+       * sessions it issues for later connections. Without a host name there
+       * is nothing to tell servers apart, so such streams are not cached. */
+      BIO_get_ssl (bio_ssl, &ssl);
+      session_key = _mongoc_openssl_session_cache_key (host, port, opt);
+      _mongoc_openssl_session_cache_install (ssl_ctx);
+      _mongoc_openssl_session_cache_attach (ssl, session_key);
+   }
+#endif
+
    openssl = (mongoc_stream_tls_openssl_t *) bson_malloc0 (sizeof *openssl);
    openssl->bio = bio_ssl;
    openssl->meth = meth;
    openssl->ctx = ssl_ctx;
    openssl->ocsp_opts = ocsp_opts;
+   openssl->session_key = session_key;
 
    tls = (mongoc_stream_tls_t *) bson_malloc0 (sizeof *tls);
    tls->parent.type = MONGOC_STREAM_TLS;
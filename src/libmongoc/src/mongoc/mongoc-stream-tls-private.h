@@ -43,6 +43,11 @@ struct _mongoc_stream_tls_t {
 };
 
 
+mongoc_stream_t *
+_mongoc_stream_tls_new_with_hostname_and_port (
+   mongoc_stream_t *base_stream, const char *host, uint16_t port, mongoc_ssl_opt_t *opt, int client);
+
+
 BSON_END_DECLS
 
 #endif /* MONGOC_STREAM_TLS_PRIVATE_H */
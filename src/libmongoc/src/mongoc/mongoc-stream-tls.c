@@ -31,6 +31,7 @@
 #if defined(MONGOC_ENABLE_SSL_OPENSSL)
 #include "mongoc-stream-tls-openssl.h"
 #include "mongoc-openssl-private.h"
+#include "mongoc-stream-tls-openssl-private.h"
 #elif defined(MONGOC_ENABLE_SSL_LIBRESSL)
 #include "mongoc-libressl-private.h"
 #include "mongoc-stream-tls-libressl.h"
@@ -187,6 +188,16 @@ mongoc_stream_tls_check_cert (mongoc_stream_t *stream, const char *host)
 
 mongoc_stream_t *
 mongoc_stream_tls_new_with_hostname (mongoc_stream_t *base_stream, const char *host, mongoc_ssl_opt_t *opt, int client)
+{
+   return _mongoc_stream_tls_new_with_hostname_and_port (base_stream, host, 0, opt, client);
+}
+
+/* Like mongoc_stream_tls_new_with_hostname, for a connection to @port on
+ * @host. The port tells apart servers on one host when TLS sessions are
+ * cached for resumption. 0 if unknown. */
+mongoc_stream_t *
+_mongoc_stream_tls_new_with_hostname_and_port (
+   mongoc_stream_t *base_stream, const char *host, uint16_t port, mongoc_ssl_opt_t *opt, int client)
 {
    BSON_ASSERT (base_stream);
 
@@ -204,12 +215,15 @@ mongoc_stream_tls_new_with_hostname (mongoc_stream_t *base_stream, const char *h
 #endif
 
 #if defined(MONGOC_ENABLE_SSL_OPENSSL)
-   return mongoc_stream_tls_openssl_new (base_stream, host, opt, client);
+   return _mongoc_stream_tls_openssl_new_with_port (base_stream, host, port, opt, client);
 #elif defined(MONGOC_ENABLE_SSL_LIBRESSL)
+   BSON_UNUSED (port);
    return mongoc_stream_tls_libressl_new (base_stream, host, opt, client);
 #elif defined(MONGOC_ENABLE_SSL_SECURE_TRANSPORT)
+   BSON_UNUSED (port);
    return mongoc_stream_tls_secure_transport_new (base_stream, host, opt, client);
 #elif defined(MONGOC_ENABLE_SSL_SECURE_CHANNEL)
+   BSON_UNUSED (port);
    return mongoc_stream_tls_secure_channel_new (base_stream, host, opt, client);
 #else
 #error "Don't know how to create TLS stream"
@@ -25,6 +25,7 @@
 #include "mongoc-log.h"
 #include "mongoc-opcode.h"
 #include "mongoc-rpc-private.h"
+#include "mongoc-socket-private.h"
 #include "mongoc-stream.h"
 #include "mongoc-stream-private.h"
 #include "mongoc-trace-private.h"
@@ -324,7 +325,12 @@ mongoc_stream_get_tls_stream (mongoc_stream_t *stream) /* IN */
 ssize_t
 mongoc_stream_poll (mongoc_stream_poll_t *streams, size_t nstreams, int32_t timeout)
 {
-   mongoc_stream_poll_t *poller = (mongoc_stream_poll_t *) bson_malloc (sizeof (*poller) * nstreams);
+   mongoc_stream_poll_t poller_prealloc[MONGOC_SOCKET_POLL_PREALLOC];
+   mongoc_stream_poll_t *poller = poller_prealloc;
+
+   if (nstreams > MONGOC_SOCKET_POLL_PREALLOC) {
+      poller = (mongoc_stream_poll_t *) bson_malloc (sizeof (*poller) * nstreams);
+   }
 
    int last_type = 0;
    ssize_t rval = -1;
@@ -358,7 +364,9 @@ mongoc_stream_poll (mongoc_stream_poll_t *streams, size_t nstreams, int32_t time
    }
 
 CLEANUP:
-   bson_free (poller);
+   if (poller != poller_prealloc) {
+      bson_free (poller);
+   }
 
    return rval;
 }
@@ -39,6 +39,7 @@
 #define MONGOC_TOPOLOGY_HEARTBEAT_FREQUENCY_MS_MULTI_THREADED 10000
 #define MONGOC_TOPOLOGY_HEARTBEAT_FREQUENCY_MS_SINGLE_THREADED 60000
 #define MONGOC_TOPOLOGY_MIN_RESCAN_SRV_INTERVAL_MS 60000
+#define MONGOC_TOPOLOGY_SESSION_SWEEP_INTERVAL_MS 60000
 
 typedef enum {
    MONGOC_TOPOLOGY_SCANNER_OFF,
@@ -171,6 +172,12 @@ typedef struct _mongoc_topology_t {
    bool stale;
 
    mongoc_server_session_pool session_pool;
+   /* Copy of the topology description's session_timeout_minutes, updated on
+    * every commit, so pooled clients can check pooled sessions for expiry
+    * without taking a reference to the description. Atomic. */
+   int64_t session_timeout_minutes;
+   /* Monotonic time of the last sweep of expired pooled sessions. Atomic. */
+   int64_t last_session_sweep_usec;
 
    /* Is client side encryption enabled? */
    mongoc_topology_cse_state_t cse_state;
@@ -360,6 +367,11 @@ _mongoc_topology_pop_server_session (mongoc_topology_t *topology, bson_error_t *
 void
 _mongoc_topology_push_server_session (mongoc_topology_t *topology, mongoc_server_session_t *server_session);
 
+/* Drop every expired session from the pool, at most once per
+ * MONGOC_TOPOLOGY_SESSION_SWEEP_INTERVAL_MS unless "force" is true. */
+void
+_mongoc_topology_sweep_server_sessions (mongoc_topology_t *topology, bool force);
+
 bool
 _mongoc_topology_end_sessions_cmd (mongoc_topology_t *topology, bson_t *cmd);
 
@@ -28,6 +28,7 @@
 
 #ifdef MONGOC_ENABLE_SSL
 #include "mongoc-stream-tls.h"
+#include "mongoc-stream-tls-private.h"
 #endif
 
 #include "mongoc-counters-private.h"
@@ -784,7 +785,8 @@ _mongoc_topology_scanner_node_setup_stream_for_tls (mongoc_topology_scanner_node
    }
 #ifdef MONGOC_ENABLE_SSL
    if (node->ts->ssl_opts) {
-      tls_stream = mongoc_stream_tls_new_with_hostname (stream, node->host.host, node->ts->ssl_opts, 1);
+      tls_stream = _mongoc_stream_tls_new_with_hostname_and_port (
+         stream, node->host.host, node->host.port, node->ts->ssl_opts, 1);
       if (!tls_stream) {
          mongoc_stream_destroy (stream);
          return NULL;
@@ -209,6 +209,19 @@ _server_session_destroy (mongoc_server_session_t *session, mongoc_topology_t *un
    _mongoc_server_session_destroy (session);
 }
 
+/* Read the session timeout without taking a reference to the topology
+ * description, which serializes on a process-wide lock. */
+static int64_t
+_session_timeout_minutes (const mongoc_topology_t *topology)
+{
+   if (topology->single_threaded) {
+      /* Only this thread modifies the description. */
+      return mc_tpld_unsafe_get_const (topology)->session_timeout_minutes;
+   }
+
+   return bson_atomic_int64_fetch (&topology->session_timeout_minutes, bson_memory_order_relaxed);
+}
+
 static int
 _server_session_should_prune (mongoc_server_session_t *session, mongoc_topology_t *topo)
 {
@@ -225,19 +238,21 @@ _server_session_should_prune (mongoc_server_session_t *session, mongoc_topology_
       return true;
    }
 
-   /* Check for a timeout */
-   mc_shared_tpld td = mc_tpld_take_ref (topo);
-   const int64_t timeout = td.ptr->session_timeout_minutes;
-   const bool is_loadbalanced = td.ptr->type == MONGOC_TOPOLOGY_LOAD_BALANCED;
-   mc_tpld_drop_ref (&td);
-
    /** Load balanced topology sessions never expire */
-   if (is_loadbalanced) {
+   if (mongoc_topology_uses_loadbalanced (topo)) {
       return false;
    }
 
    /* Prune the session if it has hit a timeout */
-   return _mongoc_server_session_timed_out (session, timeout);
+   return _mongoc_server_session_timed_out (session, _session_timeout_minutes (topo));
+}
+
+static int
+_server_session_sweep_visitor (mongoc_server_session_t *session, mongoc_topology_t *topo, void *unused)
+{
+   BSON_UNUSED (unused);
+
+   return _server_session_should_prune (session, topo);
 }
 
 static void
@@ -394,6 +409,8 @@ mongoc_topology_new (const mongoc_uri_t *uri, bool single_threaded)
    topology->usleep_fn = mongoc_usleep_default_impl;
    topology->session_pool = mongoc_server_session_pool_new_with_params (
       _server_session_init, _server_session_destroy, _server_session_should_prune, topology);
+   topology->session_timeout_minutes = MONGOC_NO_SESSIONS;
+   topology->last_session_sweep_usec = bson_get_monotonic_time ();
 
    topology->valid = false;
 
@@ -1516,10 +1533,16 @@ _mongoc_topology_pop_server_session (mongoc_topology_t *topology, bson_error_t *
    int64_t timeout;
    mongoc_server_session_t *ss = NULL;
    bool loadbalanced;
-   mc_shared_tpld td = mc_tpld_take_ref (topology);
+   mc_shared_tpld td;
 
    ENTRY;
 
+   /* Fast path: sessions are known to be supported. */
+   if (mongoc_topology_uses_loadbalanced (topology) || _session_timeout_minutes (topology) != MONGOC_NO_SESSIONS) {
+      RETURN (mongoc_server_session_pool_get (topology->session_pool, error));
+   }
+
+   td = mc_tpld_take_ref (topology);
    timeout = td.ptr->session_timeout_minutes;
    loadbalanced = td.ptr->type == MONGOC_TOPOLOGY_LOAD_BALANCED;
 
@@ -1585,13 +1608,60 @@ _mongoc_topology_push_server_session (mongoc_topology_t *topology, mongoc_server
     *
     * The next pop operation that encounters an expired session will clear the
     * entire session pool, thus preventing unbounded growth of the pool.
+    * Expired sessions that are never reached by a pop are dropped by
+    * _mongoc_topology_sweep_server_sessions, which the server monitors call
+    * for pooled clients.
     */
    mongoc_server_session_pool_return (topology->session_pool, server_session);
 
+   if (topology->single_threaded) {
+      _mongoc_topology_sweep_server_sessions (topology, false);
+   }
+
    EXIT;
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_topology_sweep_server_sessions --
+ *
+ *       Internal function. Drop expired sessions from anywhere in the
+ *       pool. Unless @force is true, does nothing if the pool was swept
+ *       less than MONGOC_TOPOLOGY_SESSION_SWEEP_INTERVAL_MS ago, or if
+ *       another thread is sweeping it.
+ *
+ *       Expired sessions have already been discarded by the server, so no
+ *       endSessions command is sent for them.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_topology_sweep_server_sessions (mongoc_topology_t *topology, bool force)
+{
+   BSON_ASSERT_PARAM (topology);
+
+   if (!force) {
+      const int64_t now = bson_get_monotonic_time ();
+      const int64_t last = bson_atomic_int64_fetch (&topology->last_session_sweep_usec, bson_memory_order_relaxed);
+
+      if (now - last < MONGOC_TOPOLOGY_SESSION_SWEEP_INTERVAL_MS * 1000) {
+         return;
+      }
+
+      /* Only the thread that advances the timestamp sweeps. */
+      if (bson_atomic_int64_compare_exchange_strong (
+             &topology->last_session_sweep_usec, last, now, bson_memory_order_relaxed) != last) {
+         return;
+      }
+   }
+
+   mongoc_server_session_pool_visit_each (topology->session_pool, NULL, _server_session_sweep_visitor);
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -1936,6 +2006,8 @@ mc_tpld_modify_commit (mc_tpld_modification mod)
    mongoc_shared_ptr old_sptr = mongoc_shared_ptr_copy (mod.topology->_shared_descr_._sptr_);
    mongoc_shared_ptr new_sptr = mongoc_shared_ptr_create (mod.new_td, _tpld_destroy_and_free);
    mongoc_atomic_shared_ptr_store (&mod.topology->_shared_descr_._sptr_, new_sptr);
+   bson_atomic_int64_exchange (
+      &mod.topology->session_timeout_minutes, mod.new_td->session_timeout_minutes, bson_memory_order_relaxed);
    bson_mutex_unlock (&mod.topology->tpld_modification_mtx);
    mongoc_shared_ptr_reset_null (&new_sptr);
    mongoc_shared_ptr_reset_null (&old_sptr);
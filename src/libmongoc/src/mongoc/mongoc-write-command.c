@@ -34,12 +34,37 @@ static const char *gCommandFields[] = {"deletes", "documents", "updates"};
 static const uint32_t gCommandFieldLens[] = {7, 9, 7};
 
 
+/* Appends @document to @payload with an "_id" element holding @oid prepended.
+ * The document's elements are copied directly into the payload rather than
+ * being assembled in a temporary bson_t first. */
+static void
+_mongoc_write_command_payload_append_with_oid (mongoc_buffer_t *payload, const bson_t *document, const bson_oid_t *oid)
+{
+   /* int32 length, then the element: type byte, "_id\0", and 12 bytes of oid. */
+   uint8_t header[4u + 1u + 4u + 12u];
+   const size_t id_element_len = sizeof header - 4u;
+   uint32_t len_le;
+
+   BSON_ASSERT (bson_in_range_unsigned (int32_t, (size_t) document->len + id_element_len));
+
+   len_le = BSON_UINT32_TO_LE (document->len + (uint32_t) id_element_len);
+   memcpy (header, &len_le, sizeof len_le);
+   header[4] = (uint8_t) BSON_TYPE_OID;
+   memcpy (header + 5, "_id", 4u);
+   memcpy (header + 9, oid->bytes, sizeof oid->bytes);
+
+   _mongoc_buffer_append (payload, header, sizeof header);
+
+   /* the original elements and trailing NUL, skipping the length prefix. */
+   _mongoc_buffer_append (payload, bson_get_data (document) + 4u, document->len - 4u);
+}
+
+
 void
 _mongoc_write_command_insert_append (mongoc_write_command_t *command, const bson_t *document)
 {
    bson_iter_t iter;
    bson_oid_t oid;
-   bson_t tmp;
 
    ENTRY;
 
@@ -53,12 +78,8 @@ _mongoc_write_command_insert_append (mongoc_write_command_t *command, const bson
     * a new oid for "_id".
     */
    if (!bson_iter_init_find (&iter, document, "_id")) {
-      bson_init (&tmp);
       bson_oid_init (&oid, NULL);
-      BSON_APPEND_OID (&tmp, "_id", &oid);
-      bson_concat (&tmp, document);
-      _mongoc_buffer_append (&command->payload, bson_get_data (&tmp), tmp.len);
-      bson_destroy (&tmp);
+      _mongoc_write_command_payload_append_with_oid (&command->payload, document, &oid);
    } else {
       _mongoc_buffer_append (&command->payload, bson_get_data (document), document->len);
    }
@@ -201,21 +222,16 @@ _mongoc_write_command_init_insert_one_idl (mongoc_write_command_t *command,
 
    bson_iter_t iter;
    bson_oid_t oid;
-   bson_t tmp;
 
    /*
     * If the document does not contain an "_id" field, we need to generate
     * a new oid for "_id".
     */
    if (!bson_iter_init_find (&iter, document, "_id")) {
-      bson_init (&tmp);
       bson_oid_init (&oid, NULL);
-      BSON_APPEND_OID (&tmp, "_id", &oid);
-      bson_concat (&tmp, document);
-      _mongoc_buffer_append (&command->payload, bson_get_data (&tmp), tmp.len);
+      _mongoc_write_command_payload_append_with_oid (&command->payload, document, &oid);
 
       BSON_APPEND_OID (insert_id, "insertedId", &oid);
-      bson_destroy (&tmp);
    } else {
       _mongoc_buffer_append (&command->payload, bson_get_data (document), document->len);
       BSON_APPEND_VALUE (insert_id, "insertedId", bson_iter_value (&iter));
@@ -27,6 +27,7 @@
 #include "mongoc-bulk-operation.h"
 #include "mongoc-bulkwrite.h"
 #include "mongoc-change-stream.h"
+#include "mongoc-change-stream-mux.h"
 #include "mongoc-client.h"
 #include "mongoc-client-pool.h"
 #include "mongoc-client-side-encryption.h"
@@ -48,6 +49,7 @@
 #include "mongoc-handshake.h"
 #include "mongoc-opcode.h"
 #include "mongoc-log.h"
+#include "mongoc-prepared-find.h"
 #include "mongoc-sleep.h"
 #include "mongoc-socket.h"
 #include "mongoc-client-session.h"
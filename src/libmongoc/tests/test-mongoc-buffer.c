@@ -34,8 +34,36 @@ test_mongoc_buffer_basic (void)
 }
 
 
+static void
+test_mongoc_buffer_append_at_least (void)
+{
+   mongoc_stream_t *stream;
+   mongoc_buffer_t buf;
+   bson_error_t error = {0};
+
+   stream = mongoc_stream_file_new_for_path (BINARY_DIR "/reply1.dat", O_RDONLY, 0);
+   ASSERT (stream);
+
+   _mongoc_buffer_init (&buf, NULL, 1024, NULL, NULL);
+
+   /* Reads everything available even though only 4 bytes are required. */
+   ASSERT_OR_PRINT (_mongoc_buffer_append_at_least_from_stream (&buf, stream, 4, 0, &error), error);
+   ASSERT_CMPSIZE_T (buf.len, ==, (size_t) 536);
+
+   ASSERT (!_mongoc_buffer_append_at_least_from_stream (&buf, stream, 4, 0, &error));
+   ASSERT_ERROR_CONTAINS (
+      error, MONGOC_ERROR_STREAM, MONGOC_ERROR_STREAM_SOCKET, "Failed to read 4 bytes: socket error or timeout");
+   ASSERT_CMPSIZE_T (buf.len, ==, (size_t) 536);
+
+   _mongoc_buffer_destroy (&buf);
+
+   mongoc_stream_destroy (stream);
+}
+
+
 void
 test_buffer_install (TestSuite *suite)
 {
    TestSuite_Add (suite, "/Buffer/Basic", test_mongoc_buffer_basic);
+   TestSuite_Add (suite, "/Buffer/append_at_least", test_mongoc_buffer_append_at_least);
 }
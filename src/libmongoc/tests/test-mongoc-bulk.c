@@ -3272,6 +3272,124 @@ test_numerous_unordered (void *ctx)
 }
 
 
+typedef struct {
+   int n_inserts;
+   int n_documents;
+   bool fail_first;
+} streaming_ctx_t;
+
+static bool
+streaming_insert_responder (request_t *request, void *data)
+{
+   streaming_ctx_t *ctx = (streaming_ctx_t *) data;
+   int n;
+
+   if (!request->is_command || 0 != strcmp (request->command_name, "insert")) {
+      return false;
+   }
+
+   /* the first doc is the command body, the rest are the inserted documents */
+   n = (int) request->docs.len - 1;
+   ctx->n_inserts++;
+   ctx->n_documents += n;
+
+   if (ctx->fail_first && ctx->n_inserts == 1) {
+      reply_to_request_simple (request,
+                               "{'ok': 1, 'n': 0,"
+                               " 'writeErrors': [{'index': 0, 'code': 11000, 'errmsg': 'dupe'}]}");
+   } else {
+      reply_to_request_simple (request, tmp_str ("{'ok': 1, 'n': %d}", n));
+   }
+
+   request_destroy (request);
+   return true;
+}
+
+static void
+_test_bulk_streaming (bool fail_first)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_server_description_t *sd;
+   mongoc_collection_t *collection;
+   mongoc_bulk_operation_t *bulk;
+   streaming_ctx_t ctx = {0};
+   bson_error_t error;
+   bson_t reply;
+   uint32_t r;
+   int i;
+
+   server = mock_server_new ();
+   mock_server_auto_hello (server,
+                           "{'ok': 1.0,"
+                           " 'isWritablePrimary': true,"
+                           " 'minWireVersion': %d,"
+                           " 'maxWireVersion': %d,"
+                           " 'maxWriteBatchSize': 2}",
+                           WIRE_VERSION_MIN,
+                           WIRE_VERSION_MAX);
+   ctx.fail_first = fail_first;
+   mock_server_autoresponds (server, streaming_insert_responder, &ctx, NULL);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   /* discover the server so the bulk knows its maxWriteBatchSize */
+   sd = mongoc_client_select_server (client, true, NULL, &error);
+   ASSERT_OR_PRINT (sd, error);
+   mongoc_server_description_destroy (sd);
+
+   collection = mongoc_client_get_collection (client, "db", "collection");
+   bulk = mongoc_collection_create_bulk_operation_with_opts (collection, NULL);
+   mongoc_bulk_operation_set_streaming (bulk, true);
+
+   for (i = 0; i < 5; i++) {
+      ASSERT_OR_PRINT (mongoc_bulk_operation_insert_with_opts (bulk, tmp_bson ("{'_id': %d}", i), NULL, &error),
+                       error);
+      /* each full batch is sent while the application is still appending,
+       * until an ordered bulk fails */
+      ASSERT_CMPINT (ctx.n_inserts, ==, fail_first ? (i >= 1) : (i + 1) / 2);
+      if (fail_first && i >= 1) {
+         /* operations added after the failure are not queued */
+         ASSERT_CMPSIZE_T (bulk->commands.len, ==, (size_t) 0);
+      }
+   }
+
+   r = mongoc_bulk_operation_execute (bulk, &reply, &error);
+
+   if (fail_first) {
+      ASSERT (!r);
+      ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_COMMAND, 11000, "dupe");
+      ASSERT_CMPINT (ctx.n_inserts, ==, 1);
+      ASSERT_MATCH (&reply, "{'nInserted': 0, 'writeErrors': [{'index': 0, 'code': 11000}]}");
+   } else {
+      ASSERT_OR_PRINT (r, error);
+      ASSERT_CMPINT (ctx.n_inserts, ==, 3);
+      ASSERT_CMPINT (ctx.n_documents, ==, 5);
+      ASSERT_MATCH (&reply, "{'nInserted': 5, 'writeErrors': []}");
+   }
+
+   bson_destroy (&reply);
+   mongoc_bulk_operation_destroy (bulk);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
+static void
+test_bulk_streaming (void)
+{
+   _test_bulk_streaming (false);
+}
+
+
+static void
+test_bulk_streaming_ordered_error (void)
+{
+   _test_bulk_streaming (true);
+}
+
+
 static void
 test_bulk_split (void *ctx)
 {
@@ -4859,6 +4977,8 @@ test_bulk_install (TestSuite *suite)
    TestSuite_AddLive (suite, "/BulkOperation/CDRIVER-372_ordered", test_bulk_edge_case_372_ordered);
    TestSuite_AddLive (suite, "/BulkOperation/CDRIVER-372_unordered", test_bulk_edge_case_372_unordered);
    TestSuite_AddLive (suite, "/BulkOperation/new", test_bulk_new);
+   TestSuite_AddMockServerTest (suite, "/BulkOperation/streaming", test_bulk_streaming);
+   TestSuite_AddMockServerTest (suite, "/BulkOperation/streaming/ordered_error", test_bulk_streaming_ordered_error);
    TestSuite_AddLive (suite, "/BulkOperation/OP_MSG/max_batch_size", test_bulk_max_batch_size);
    TestSuite_AddLive (suite, "/BulkOperation/OP_MSG/max_msg_size", test_bulk_max_msg_size);
    TestSuite_AddFull (suite,
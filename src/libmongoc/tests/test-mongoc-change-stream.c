@@ -2125,6 +2125,107 @@ prose_test_18 (void)
 }
 
 
+/* one change stream dispatches its events to subscribers with filters. */
+/* accept events whose operationType is the string @ctx */
+static bool
+_mux_filter_operation_type (const bson_t *event, void *ctx)
+{
+   bson_iter_t iter;
+
+   return bson_iter_init_find (&iter, event, "operationType") && BSON_ITER_HOLDS_UTF8 (&iter) &&
+          0 == strcmp (bson_iter_utf8 (&iter, NULL), (const char *) ctx);
+}
+
+/* accept events whose fullDocument.x is 2 */
+static bool
+_mux_filter_x_is_2 (const bson_t *event, void *ctx)
+{
+   bson_iter_t iter;
+   bson_iter_t x;
+
+   BSON_UNUSED (ctx);
+
+   return bson_iter_init (&iter, event) && bson_iter_find_descendant (&iter, "fullDocument.x", &x) &&
+          BSON_ITER_HOLDS_INT (&x) && bson_iter_as_int64 (&x) == 2;
+}
+
+
+static void
+test_change_stream_mux (void)
+{
+   mock_server_t *server;
+   request_t *request;
+   future_t *future;
+   mongoc_client_t *client;
+   mongoc_collection_t *coll;
+   mongoc_change_stream_t *stream;
+   mongoc_change_stream_mux_t *mux;
+   mongoc_change_stream_subscriber_t *inserts;
+   mongoc_change_stream_subscriber_t *x_is_2;
+   mongoc_change_stream_subscriber_t *bounded;
+   bson_error_t error;
+   const bson_t *doc;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MAX);
+   mock_server_run (server);
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   coll = mongoc_client_get_collection (client, "db", "coll");
+
+   future = future_collection_watch (coll, tmp_bson ("{}"), NULL);
+   request = mock_server_receives_msg (server, MONGOC_QUERY_NONE, tmp_bson ("{'aggregate': 'coll'}"));
+   /* Reply with a 0 cursor ID to prevent getMore and killCursors commands. */
+   reply_to_request_simple (request,
+                            "{'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': ["
+                            "   {'_id': {'t': 1}, 'operationType': 'insert', 'fullDocument': {'x': 1}},"
+                            "   {'_id': {'t': 2}, 'operationType': 'delete'},"
+                            "   {'_id': {'t': 3}, 'operationType': 'insert', 'fullDocument': {'x': 2}}],"
+                            " 'postBatchResumeToken': {'t': 4}}, 'ok': 1}");
+   request_destroy (request);
+   stream = future_get_mongoc_change_stream_ptr (future);
+   BSON_ASSERT (stream);
+   future_destroy (future);
+
+   mux = mongoc_change_stream_mux_new (stream);
+
+   inserts = mongoc_change_stream_mux_subscribe (mux, _mux_filter_operation_type, "insert", 0);
+   x_is_2 = mongoc_change_stream_mux_subscribe (mux, _mux_filter_x_is_2, NULL, 0);
+   bounded = mongoc_change_stream_mux_subscribe (mux, NULL, NULL, 1);
+
+   BSON_ASSERT (mongoc_change_stream_subscriber_next (inserts, &doc));
+   ASSERT_MATCH (doc, "{'_id': {'t': 1}}");
+   ASSERT_MATCH (mongoc_change_stream_subscriber_get_resume_token (inserts), "{'t': 1}");
+
+   /* reads past the delete event, which overflows the queue of "bounded" */
+   BSON_ASSERT (mongoc_change_stream_subscriber_next (x_is_2, &doc));
+   ASSERT_MATCH (doc, "{'_id': {'t': 3}}");
+
+   BSON_ASSERT (mongoc_change_stream_subscriber_next (inserts, &doc));
+   ASSERT_MATCH (doc, "{'_id': {'t': 3}}");
+
+   /* no more events, so the resume token is the stream's */
+   BSON_ASSERT (!mongoc_change_stream_subscriber_next (inserts, &doc));
+   BSON_ASSERT (!doc);
+   ASSERT_OR_PRINT (!mongoc_change_stream_subscriber_error_document (inserts, &error, NULL), error);
+   ASSERT_MATCH (mongoc_change_stream_subscriber_get_resume_token (inserts), "{'t': 4}");
+   ASSERT_MATCH (mongoc_change_stream_subscriber_get_resume_token (x_is_2), "{'t': 4}");
+
+   BSON_ASSERT (!mongoc_change_stream_subscriber_next (bounded, &doc));
+   BSON_ASSERT (mongoc_change_stream_subscriber_error_document (bounded, &error, NULL));
+   ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_CURSOR, MONGOC_ERROR_CURSOR_INVALID_CURSOR, "more than 1 queued");
+   /* it never received an event, so it resumes from the start of the stream */
+   BSON_ASSERT (!mongoc_change_stream_subscriber_get_resume_token (bounded));
+
+   mongoc_change_stream_subscriber_destroy (inserts);
+   mongoc_change_stream_subscriber_destroy (x_is_2);
+   mongoc_change_stream_subscriber_destroy (bounded);
+   mongoc_change_stream_mux_destroy (mux);
+
+   mongoc_collection_destroy (coll);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
 void
 test_change_stream_install (TestSuite *suite)
 {
@@ -2267,4 +2368,5 @@ test_change_stream_install (TestSuite *suite)
                       test_framework_skip_if_not_rs_version_7);
    TestSuite_AddMockServerTest (suite, "/change_streams/prose_test_17", prose_test_17);
    TestSuite_AddMockServerTest (suite, "/change_streams/prose_test_18", prose_test_18);
+   TestSuite_AddMockServerTest (suite, "/change_stream/mux", test_change_stream_mux);
 }
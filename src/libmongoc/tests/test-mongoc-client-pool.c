@@ -6,6 +6,9 @@
 
 #include "TestSuite.h"
 #include "test-libmongoc.h"
+#include "test-conveniences.h"
+#include "mock_server/mock-server.h"
+#include "mock_server/future-functions.h"
 
 
 static void
@@ -635,6 +638,811 @@ disconnects_removed_servers_in_pool (void *unused)
    bson_destroy (ping);
 }
 
+static void
+test_client_pool_new_shared (void)
+{
+   mongoc_client_pool_t *pool_a;
+   mongoc_client_pool_t *pool_b;
+   mongoc_client_pool_t *pool_c;
+   mongoc_client_pool_t *pool_d;
+   mongoc_client_t *client;
+   mongoc_uri_t *uri;
+   bson_error_t error;
+
+   uri = mongoc_uri_new ("mongodb://127.0.0.1/?maxpoolsize=1");
+   pool_a = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_a, error);
+   mongoc_uri_destroy (uri);
+
+   /* Pool-only options do not prevent sharing. */
+   uri = mongoc_uri_new ("mongodb://127.0.0.1/?maxpoolsize=5&waitqueuetimeoutms=100");
+   pool_b = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_b, error);
+   mongoc_uri_destroy (uri);
+
+   /* A different deployment gets its own topology. */
+   uri = mongoc_uri_new ("mongodb://127.0.0.1:27018/?maxpoolsize=1");
+   pool_c = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_c, error);
+
+   /* Pools created without opting in never share. */
+   pool_d = mongoc_client_pool_new (uri);
+   mongoc_uri_destroy (uri);
+
+   ASSERT (_mongoc_client_pool_get_topology (pool_a) == _mongoc_client_pool_get_topology (pool_b));
+   ASSERT (_mongoc_client_pool_get_topology (pool_a) != _mongoc_client_pool_get_topology (pool_c));
+   ASSERT (_mongoc_client_pool_get_topology (pool_c) != _mongoc_client_pool_get_topology (pool_d));
+
+   /* Pool sizes are still enforced per pool. */
+   client = mongoc_client_pool_pop (pool_a);
+   ASSERT (client);
+   ASSERT (!mongoc_client_pool_try_pop (pool_a));
+   mongoc_client_pool_push (pool_a, client);
+   ASSERT_CMPSIZE_T (mongoc_client_pool_get_size (pool_b), ==, 0);
+
+   /* The remaining pool keeps using the topology after the first is destroyed. */
+   mongoc_client_pool_destroy (pool_a);
+   client = mongoc_client_pool_pop (pool_b);
+   ASSERT (client);
+   mongoc_client_pool_push (pool_b, client);
+
+   mongoc_client_pool_destroy (pool_b);
+   mongoc_client_pool_destroy (pool_c);
+   mongoc_client_pool_destroy (pool_d);
+}
+
+
+static void
+test_client_pool_new_shared_appname (void)
+{
+   mongoc_client_pool_t *pool_a;
+   mongoc_client_pool_t *pool_b;
+   mongoc_uri_t *uri;
+   bson_error_t error;
+
+   uri = mongoc_uri_new ("mongodb://127.0.0.1/?appname=foo");
+   pool_a = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_a, error);
+   /* Previously aborted trying to set the appname on the topology again. */
+   pool_b = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_b, error);
+
+   ASSERT (_mongoc_client_pool_get_topology (pool_a) == _mongoc_client_pool_get_topology (pool_b));
+   ASSERT_CMPSTR (_mongoc_client_pool_get_topology (pool_a)->scanner->appname, "foo");
+
+   mongoc_client_pool_destroy (pool_b);
+   mongoc_client_pool_destroy (pool_a);
+   mongoc_uri_destroy (uri);
+}
+
+
+static void
+test_client_pool_new_shared_concerns (void)
+{
+   mongoc_client_pool_t *pool_a;
+   mongoc_client_pool_t *pool_b;
+   mongoc_client_t *client_a;
+   mongoc_client_t *client_b;
+   mongoc_uri_t *uri;
+   mongoc_write_concern_t *wc;
+   mongoc_read_concern_t *rc;
+   mongoc_read_prefs_t *prefs;
+   bson_error_t error;
+
+   uri = mongoc_uri_new ("mongodb://127.0.0.1");
+   pool_a = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_a, error);
+
+   /* Concerns and read preferences set in code are not URI options, so the
+    * pools still share a topology. */
+   wc = mongoc_write_concern_new ();
+   mongoc_write_concern_set_w (wc, MONGOC_WRITE_CONCERN_W_MAJORITY);
+   mongoc_uri_set_write_concern (uri, wc);
+   rc = mongoc_read_concern_new ();
+   mongoc_read_concern_set_level (rc, MONGOC_READ_CONCERN_LEVEL_MAJORITY);
+   mongoc_uri_set_read_concern (uri, rc);
+   prefs = mongoc_read_prefs_new (MONGOC_READ_SECONDARY);
+   mongoc_uri_set_read_prefs_t (uri, prefs);
+   pool_b = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_b, error);
+   ASSERT (_mongoc_client_pool_get_topology (pool_a) == _mongoc_client_pool_get_topology (pool_b));
+
+   client_a = mongoc_client_pool_pop (pool_a);
+   client_b = mongoc_client_pool_pop (pool_b);
+
+   /* Each pool's clients use the settings of that pool's URI. */
+   ASSERT_CMPINT32 (mongoc_write_concern_get_w (mongoc_client_get_write_concern (client_a)),
+                    ==,
+                    MONGOC_WRITE_CONCERN_W_DEFAULT);
+   ASSERT (!mongoc_read_concern_get_level (mongoc_client_get_read_concern (client_a)));
+   ASSERT_CMPINT (mongoc_read_prefs_get_mode (mongoc_client_get_read_prefs (client_a)), ==, MONGOC_READ_PRIMARY);
+
+   ASSERT_CMPINT32 (mongoc_write_concern_get_w (mongoc_client_get_write_concern (client_b)),
+                    ==,
+                    MONGOC_WRITE_CONCERN_W_MAJORITY);
+   ASSERT_CMPSTR (mongoc_read_concern_get_level (mongoc_client_get_read_concern (client_b)),
+                  MONGOC_READ_CONCERN_LEVEL_MAJORITY);
+   ASSERT_CMPINT (mongoc_read_prefs_get_mode (mongoc_client_get_read_prefs (client_b)), ==, MONGOC_READ_SECONDARY);
+   ASSERT_CMPINT32 (mongoc_write_concern_get_w (mongoc_uri_get_write_concern (mongoc_client_get_uri (client_b))),
+                    ==,
+                    MONGOC_WRITE_CONCERN_W_MAJORITY);
+
+   mongoc_client_pool_push (pool_b, client_b);
+   mongoc_client_pool_push (pool_a, client_a);
+   mongoc_client_pool_destroy (pool_b);
+   mongoc_client_pool_destroy (pool_a);
+   mongoc_read_prefs_destroy (prefs);
+   mongoc_read_concern_destroy (rc);
+   mongoc_write_concern_destroy (wc);
+   mongoc_uri_destroy (uri);
+}
+
+
+static void
+shared_heartbeat_failed (const mongoc_apm_server_heartbeat_failed_t *event)
+{
+   BSON_UNUSED (event);
+}
+
+
+static void
+test_client_pool_new_shared_apm (void)
+{
+   mongoc_client_pool_t *pool_a;
+   mongoc_client_pool_t *pool_b;
+   mongoc_client_t *client;
+   mongoc_apm_callbacks_t *callbacks_a;
+   mongoc_apm_callbacks_t *callbacks_b;
+   mongoc_topology_t *topology;
+   mc_shared_tpld td;
+   mongoc_uri_t *uri;
+   bson_error_t error;
+   int context_a = 0;
+   int context_b = 0;
+
+   uri = mongoc_uri_new ("mongodb://127.0.0.1");
+   pool_a = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_a, error);
+   pool_b = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_b, error);
+   topology = _mongoc_client_pool_get_topology (pool_a);
+
+   callbacks_a = mongoc_apm_callbacks_new ();
+   mongoc_apm_set_server_heartbeat_failed_cb (callbacks_a, shared_heartbeat_failed);
+   ASSERT (mongoc_client_pool_set_apm_callbacks (pool_a, callbacks_a, &context_a));
+
+   /* Destroying the pool that set the SDAM callbacks leaves them installed,
+    * since server monitors keep their own copy. */
+   mongoc_client_pool_destroy (pool_a);
+
+   /* Start monitoring. */
+   client = mongoc_client_pool_pop (pool_b);
+   mongoc_client_pool_push (pool_b, client);
+
+   /* Once monitoring started, other pools only set command callbacks. */
+   callbacks_b = mongoc_apm_callbacks_new ();
+   ASSERT (mongoc_client_pool_set_apm_callbacks (pool_b, callbacks_b, &context_b));
+
+   td = mc_tpld_take_ref (topology);
+   ASSERT (td.ptr->apm_callbacks.server_heartbeat_failed == shared_heartbeat_failed);
+   ASSERT (td.ptr->apm_context == &context_a);
+   mc_tpld_drop_ref (&td);
+
+   mongoc_client_pool_destroy (pool_b);
+   mongoc_apm_callbacks_destroy (callbacks_b);
+   mongoc_apm_callbacks_destroy (callbacks_a);
+   mongoc_uri_destroy (uri);
+}
+
+
+#ifdef MONGOC_ENABLE_SSL
+static void
+test_client_pool_new_shared_ssl_opts (void)
+{
+   mongoc_client_pool_t *pool_a;
+   mongoc_client_pool_t *pool_b;
+   mongoc_client_t *client;
+   mongoc_topology_t *topology;
+   mongoc_ssl_opt_t opts = {0};
+   mongoc_uri_t *uri;
+   bson_error_t error;
+
+   uri = mongoc_uri_new ("mongodb://127.0.0.1/?tls=true&tlsAllowInvalidHostnames=true");
+   pool_a = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_a, error);
+   topology = _mongoc_client_pool_get_topology (pool_a);
+   ASSERT (topology->scanner->ssl_opts->allow_invalid_hostname);
+
+   /* Options may still change before monitoring starts. */
+   opts.allow_invalid_hostname = false;
+   mongoc_client_pool_set_ssl_opts (pool_a, &opts);
+   ASSERT (!topology->scanner->ssl_opts->allow_invalid_hostname);
+
+   /* Creating another pool does not reset the topology's options. */
+   pool_b = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_b, error);
+   ASSERT (!topology->scanner->ssl_opts->allow_invalid_hostname);
+
+   /* Start monitoring. */
+   client = mongoc_client_pool_pop (pool_a);
+   mongoc_client_pool_push (pool_a, client);
+
+   /* Monitors keep their options, the pool's own clients use the new ones. */
+   opts.allow_invalid_hostname = true;
+   mongoc_client_pool_set_ssl_opts (pool_b, &opts);
+   ASSERT (!topology->scanner->ssl_opts->allow_invalid_hostname);
+
+   client = mongoc_client_pool_pop (pool_b);
+   ASSERT (client->ssl_opts.allow_invalid_hostname);
+   mongoc_client_pool_push (pool_b, client);
+
+   mongoc_client_pool_destroy (pool_a);
+   mongoc_client_pool_destroy (pool_b);
+   mongoc_uri_destroy (uri);
+}
+#endif
+
+
+static void
+test_client_pool_new_shared_server_api (void)
+{
+   mongoc_client_pool_t *pool_a;
+   mongoc_client_pool_t *pool_b;
+   mongoc_client_pool_t *pool_c;
+   mongoc_client_t *client;
+   mongoc_server_api_t *api;
+   mongoc_server_api_t *strict_api;
+   mongoc_uri_t *uri;
+   bson_error_t error;
+
+   api = mongoc_server_api_new (MONGOC_SERVER_API_V1);
+   strict_api = mongoc_server_api_new (MONGOC_SERVER_API_V1);
+   mongoc_server_api_strict (strict_api, true);
+
+   uri = mongoc_uri_new ("mongodb://127.0.0.1");
+   pool_a = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_a, error);
+   pool_b = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_b, error);
+   pool_c = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_c, error);
+
+   ASSERT_OR_PRINT (mongoc_client_pool_set_server_api (pool_a, api, &error), error);
+
+   /* A differing API is rejected, an equal one is accepted. */
+   ASSERT (!mongoc_client_pool_set_server_api (pool_b, strict_api, &error));
+   ASSERT_ERROR_CONTAINS (
+      error, MONGOC_ERROR_POOL, MONGOC_ERROR_POOL_API_ALREADY_SET, "different from the one used by the shared topology");
+   ASSERT_OR_PRINT (mongoc_client_pool_set_server_api (pool_b, api, &error), error);
+
+   mongoc_client_pool_destroy (pool_b);
+   mongoc_client_pool_destroy (pool_c);
+   mongoc_client_pool_destroy (pool_a);
+   mongoc_uri_destroy (uri);
+
+   /* An API cannot be declared once monitoring started without one. */
+   uri = mongoc_uri_new ("mongodb://127.0.0.1:27018");
+   pool_a = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_a, error);
+   pool_b = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool_b, error);
+
+   client = mongoc_client_pool_pop (pool_a);
+   mongoc_client_pool_push (pool_a, client);
+
+   ASSERT (!mongoc_client_pool_set_server_api (pool_b, api, &error));
+   ASSERT_ERROR_CONTAINS (
+      error, MONGOC_ERROR_POOL, MONGOC_ERROR_POOL_API_TOO_LATE, "after the shared topology started monitoring");
+
+   mongoc_client_pool_destroy (pool_b);
+   mongoc_client_pool_destroy (pool_a);
+   mongoc_uri_destroy (uri);
+   mongoc_server_api_destroy (strict_api);
+   mongoc_server_api_destroy (api);
+}
+
+
+static void
+test_client_pool_new_shared_rejects_auto_encryption (void)
+{
+   mongoc_client_pool_t *pool;
+   mongoc_auto_encryption_opts_t *opts;
+   mongoc_uri_t *uri;
+   bson_error_t error;
+
+   uri = mongoc_uri_new ("mongodb://127.0.0.1");
+   pool = mongoc_client_pool_new_shared (uri, &error);
+   ASSERT_OR_PRINT (pool, error);
+
+   opts = mongoc_auto_encryption_opts_new ();
+   ASSERT (!mongoc_client_pool_enable_auto_encryption (pool, opts, &error));
+   ASSERT_ERROR_CONTAINS (error,
+                          MONGOC_ERROR_CLIENT,
+                          MONGOC_ERROR_CLIENT_INVALID_ENCRYPTION_STATE,
+                          "cannot be enabled on a pool with a shared topology");
+
+   mongoc_auto_encryption_opts_destroy (opts);
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+}
+
+#define PARALLEL_SCAN_N_DOCS 10
+
+typedef struct {
+   bson_mutex_t mutex;
+   int seen[PARALLEL_SCAN_N_DOCS];
+   int calls;
+   int stop_after;
+} parallel_scan_ctx_t;
+
+static bool
+parallel_scan_cb (const bson_t *document, void *ctx_void)
+{
+   parallel_scan_ctx_t *ctx = (parallel_scan_ctx_t *) ctx_void;
+   int32_t id = bson_lookup_int32 (document, "_id");
+   bool keep_going;
+
+   ASSERT_CMPINT32 (id, >=, 0);
+   ASSERT_CMPINT32 (id, <, PARALLEL_SCAN_N_DOCS);
+
+   bson_mutex_lock (&ctx->mutex);
+   ctx->seen[id]++;
+   ctx->calls++;
+   keep_going = ctx->stop_after == 0 || ctx->calls < ctx->stop_after;
+   bson_mutex_unlock (&ctx->mutex);
+
+   return keep_going;
+}
+
+/* replies to $sample with _ids 1..8 and to find with the documents with _ids
+ * 0..9 that fall within the requested min and max. fails the find starting at
+ * the _id passed as data, if any. */
+static bool
+parallel_scan_responder (request_t *request, void *data)
+{
+   const int32_t fail_at = *(int32_t *) data;
+   const bson_t *cmd;
+   int32_t min = 0;
+   int32_t max = PARALLEL_SCAN_N_DOCS;
+   bson_t reply;
+   bson_t cursor;
+   bson_t batch;
+   uint32_t n = 0u;
+   int32_t i;
+
+   if (!request->is_command) {
+      return false;
+   }
+
+   cmd = request_get_doc (request, 0);
+
+   if (0 == strcmp (request->command_name, "aggregate")) {
+      ASSERT (bson_has_field (cmd, "pipeline.0.$sample"));
+      min = 1;
+      max = PARALLEL_SCAN_N_DOCS - 1;
+   } else if (0 == strcmp (request->command_name, "find")) {
+      if (bson_has_field (cmd, "min")) {
+         min = bson_lookup_int32 (cmd, "min._id");
+      }
+      if (bson_has_field (cmd, "max")) {
+         max = bson_lookup_int32 (cmd, "max._id");
+      }
+      if (fail_at >= 0 && min == fail_at) {
+         reply_to_request_simple (request, "{'ok': 0, 'code': 2, 'errmsg': 'range failed'}");
+         request_destroy (request);
+         return true;
+      }
+   } else {
+      return false;
+   }
+
+   bson_init (&reply);
+   BSON_APPEND_INT32 (&reply, "ok", 1);
+   BSON_APPEND_DOCUMENT_BEGIN (&reply, "cursor", &cursor);
+   BSON_APPEND_INT64 (&cursor, "id", 0);
+   BSON_APPEND_UTF8 (&cursor, "ns", "db.coll");
+   BSON_APPEND_ARRAY_BEGIN (&cursor, "firstBatch", &batch);
+   for (i = min; i < max; i++) {
+      bson_t doc;
+      const char *key;
+      char buf[16];
+
+      bson_uint32_to_string (n++, &key, buf, sizeof buf);
+      BSON_APPEND_DOCUMENT_BEGIN (&batch, key, &doc);
+      BSON_APPEND_INT32 (&doc, "_id", i);
+      bson_append_document_end (&batch, &doc);
+   }
+   bson_append_array_end (&cursor, &batch);
+   bson_append_document_end (&reply, &cursor);
+
+   reply_to_op_msg_request (request, MONGOC_MSG_NONE, &reply);
+   bson_destroy (&reply);
+   request_destroy (request);
+
+   return true;
+}
+
+static void
+_test_client_pool_parallel_scan (int32_t fail_at, int stop_after)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   parallel_scan_ctx_t ctx = {0};
+   bson_error_t error;
+   bool ret;
+   int i;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MIN);
+   mock_server_autoresponds (server, parallel_scan_responder, &fail_at, NULL);
+   mock_server_run (server);
+
+   pool = test_framework_client_pool_new_from_uri (mock_server_get_uri (server), NULL);
+   bson_mutex_init (&ctx.mutex);
+   ctx.stop_after = stop_after;
+
+   ret = mongoc_client_pool_parallel_scan (pool, "db", "coll", NULL, NULL, 4, parallel_scan_cb, &ctx, &error);
+
+   if (fail_at >= 0) {
+      ASSERT (!ret);
+      ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_QUERY, 2, "range failed");
+   } else if (stop_after > 0) {
+      ASSERT_OR_PRINT (ret, error);
+      /* each worker stops at its next document once the flag is set */
+      ASSERT_CMPINT (ctx.calls, >=, stop_after);
+      ASSERT_CMPINT (ctx.calls, <, PARALLEL_SCAN_N_DOCS);
+   } else {
+      ASSERT_OR_PRINT (ret, error);
+      ASSERT_CMPINT (ctx.calls, ==, PARALLEL_SCAN_N_DOCS);
+      for (i = 0; i < PARALLEL_SCAN_N_DOCS; i++) {
+         ASSERT_CMPINT (ctx.seen[i], ==, 1);
+      }
+   }
+
+   bson_mutex_destroy (&ctx.mutex);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+}
+
+static void
+test_client_pool_parallel_scan (void)
+{
+   _test_client_pool_parallel_scan (-1 /* fail_at */, 0 /* stop_after */);
+}
+
+static void
+test_client_pool_parallel_scan_stop (void)
+{
+   _test_client_pool_parallel_scan (-1 /* fail_at */, 1 /* stop_after */);
+}
+
+static void
+test_client_pool_parallel_scan_error (void)
+{
+   _test_client_pool_parallel_scan (5 /* fail_at */, 0 /* stop_after */);
+}
+
+static void
+test_client_pool_parallel_scan_invalid_opts (void)
+{
+   mongoc_client_pool_t *pool;
+   parallel_scan_ctx_t ctx = {0};
+   bson_error_t error;
+   mongoc_uri_t *uri;
+
+   uri = mongoc_uri_new ("mongodb://localhost");
+   pool = test_framework_client_pool_new_from_uri (uri, NULL);
+
+   ASSERT (!mongoc_client_pool_parallel_scan (
+      pool, "db", "coll", NULL, tmp_bson ("{'sort': {'a': 1}}"), 4, parallel_scan_cb, &ctx, &error));
+   ASSERT_ERROR_CONTAINS (
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Cannot specify \"sort\" for a parallel scan");
+
+   ASSERT (!mongoc_client_pool_parallel_scan (pool, "db", "coll", NULL, NULL, 0, parallel_scan_cb, &ctx, &error));
+   ASSERT_ERROR_CONTAINS (
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "max_workers must be greater than zero");
+
+   ASSERT_CMPINT (ctx.calls, ==, 0);
+
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+}
+
+
+#define INSERT_ONE_N_THREADS 8
+
+typedef struct {
+   bson_mutex_t mutex;
+   int n_inserts;
+   int n_documents;
+   /* if nonzero, the insert command with this number fails */
+   int fail_insert;
+   int n_failed_documents;
+   int max_write_batch_size;
+} insert_one_server_ctx_t;
+
+typedef struct {
+   mongoc_client_pool_t *pool;
+   int32_t id;
+   bson_thread_t thread;
+   bool ret;
+   bson_error_t error;
+} insert_one_worker_t;
+
+/* replies to each insert with a duplicate key error for the document with _id
+ * 3, delaying the first insert so the other callers' documents queue up. */
+static bool
+insert_one_responder (request_t *request, void *data)
+{
+   insert_one_server_ctx_t *ctx = (insert_one_server_ctx_t *) data;
+   bson_string_t *write_errors;
+   int n;
+   int n_errors = 0;
+   int n_inserts;
+   int i;
+
+   if (!request->is_command || 0 != strcmp (request->command_name, "insert")) {
+      return false;
+   }
+
+   n = (int) request->docs.len - 1;
+
+   bson_mutex_lock (&ctx->mutex);
+   n_inserts = ++ctx->n_inserts;
+   ctx->n_documents += n;
+   bson_mutex_unlock (&ctx->mutex);
+
+   /* the first insert is the test's own; the second is the first from the
+    * worker threads */
+   if (n_inserts == 2) {
+      _mongoc_usleep (200 * 1000);
+   }
+
+   if (ctx->max_write_batch_size) {
+      ASSERT_CMPINT (n, <=, ctx->max_write_batch_size);
+   }
+
+   if (n_inserts == ctx->fail_insert) {
+      bson_mutex_lock (&ctx->mutex);
+      ctx->n_failed_documents = n;
+      bson_mutex_unlock (&ctx->mutex);
+
+      reply_to_request_simple (request, "{'ok': 0, 'code': 2, 'errmsg': 'insert failed'}");
+      request_destroy (request);
+      return true;
+   }
+
+   write_errors = bson_string_new ("[");
+   for (i = 0; i < n; i++) {
+      const bson_t *doc = request_get_doc (request, (size_t) i + 1u);
+
+      bson_iter_t iter;
+
+      if (bson_iter_init_find (&iter, doc, "_id") && BSON_ITER_HOLDS_INT32 (&iter) && bson_iter_int32 (&iter) == 3) {
+         bson_string_append_printf (write_errors, "{'index': %d, 'code': 11000, 'errmsg': 'dupe'}", i);
+         n_errors++;
+      }
+   }
+   bson_string_append (write_errors, "]");
+
+   reply_to_request_simple (request,
+                            tmp_str ("{'ok': 1, 'n': %d, 'writeErrors': %s}", n - n_errors, write_errors->str));
+
+   bson_string_free (write_errors, true);
+   request_destroy (request);
+
+   return true;
+}
+
+static BSON_THREAD_FUN (insert_one_worker, data)
+{
+   insert_one_worker_t *worker = (insert_one_worker_t *) data;
+   bson_t reply;
+   bson_error_t error;
+   bool ret;
+
+   ret = mongoc_client_pool_insert_one (
+      worker->pool, "db", "coll", tmp_bson ("{'_id': %d, 'x': 1}", worker->id), &reply, &error);
+
+   if (worker->id == 3) {
+      ASSERT (!ret);
+      ASSERT_ERROR_CONTAINS (error, MONGOC_ERROR_COLLECTION, 11000, "dupe");
+      /* the error is numbered as in a single insert */
+      ASSERT_MATCH (&reply, "{'insertedCount': 0, 'writeErrors': [{'index': 0, 'code': 11000}]}");
+   } else {
+      ASSERT_OR_PRINT (ret, error);
+      ASSERT_MATCH (&reply, "{'insertedCount': 1, 'insertedId': %d}", worker->id);
+   }
+
+   bson_destroy (&reply);
+
+   BSON_THREAD_RETURN;
+}
+
+static void
+test_client_pool_insert_one (void)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   insert_one_server_ctx_t ctx = {0};
+   insert_one_worker_t workers[INSERT_ONE_N_THREADS];
+   bson_t reply;
+   bson_error_t error;
+   int i;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MIN);
+   bson_mutex_init (&ctx.mutex);
+   mock_server_autoresponds (server, insert_one_responder, &ctx, NULL);
+   mock_server_run (server);
+
+   pool = test_framework_client_pool_new_from_uri (mock_server_get_uri (server), NULL);
+
+   /* a document without _id gets one generated, returned as insertedId */
+   ASSERT_OR_PRINT (mongoc_client_pool_insert_one (pool, "db", "coll", tmp_bson ("{'x': 1}"), &reply, &error), error);
+   ASSERT_MATCH (&reply, "{'insertedCount': 1, 'insertedId': {'$exists': true}}");
+   bson_destroy (&reply);
+
+   for (i = 0; i < INSERT_ONE_N_THREADS; i++) {
+      workers[i].pool = pool;
+      workers[i].id = i;
+      ASSERT_CMPINT (0, ==, mcommon_thread_create (&workers[i].thread, insert_one_worker, &workers[i]));
+   }
+
+   for (i = 0; i < INSERT_ONE_N_THREADS; i++) {
+      mcommon_thread_join (workers[i].thread);
+   }
+
+   /* the documents that arrived while the first batch was in flight were sent
+    * together */
+   ASSERT_CMPINT (ctx.n_documents, ==, INSERT_ONE_N_THREADS + 1);
+   ASSERT_CMPINT (ctx.n_inserts, <, INSERT_ONE_N_THREADS + 1);
+
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   bson_mutex_destroy (&ctx.mutex);
+}
+
+
+static BSON_THREAD_FUN (insert_one_split_worker, data)
+{
+   insert_one_worker_t *worker = (insert_one_worker_t *) data;
+   bson_t reply;
+
+   worker->ret = mongoc_client_pool_insert_one (
+      worker->pool, "db", "coll", tmp_bson ("{'_id': %d}", worker->id), &reply, &worker->error);
+   bson_destroy (&reply);
+
+   BSON_THREAD_RETURN;
+}
+
+/* a batch larger than maxWriteBatchSize is sent in several insert commands. A
+ * failed command only fails the calls whose documents it carried. */
+static void
+test_client_pool_insert_one_split (void)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   insert_one_server_ctx_t ctx = {0};
+   insert_one_worker_t workers[INSERT_ONE_N_THREADS];
+   bson_t reply;
+   bson_error_t error;
+   int n_failed = 0;
+   int i;
+
+   server = mock_server_new ();
+   mock_server_auto_hello (server,
+                           "{'ok': 1.0,"
+                           " 'isWritablePrimary': true,"
+                           " 'minWireVersion': %d,"
+                           " 'maxWireVersion': %d,"
+                           " 'maxWriteBatchSize': 2}",
+                           WIRE_VERSION_MIN,
+                           WIRE_VERSION_MAX);
+   bson_mutex_init (&ctx.mutex);
+   ctx.max_write_batch_size = 2;
+   /* the first command of the batch queued behind the delayed insert */
+   ctx.fail_insert = 3;
+   mock_server_autoresponds (server, insert_one_responder, &ctx, NULL);
+   mock_server_run (server);
+
+   pool = test_framework_client_pool_new_from_uri (mock_server_get_uri (server), NULL);
+
+   ASSERT_OR_PRINT (mongoc_client_pool_insert_one (pool, "db", "coll", tmp_bson ("{'x': 1}"), &reply, &error), error);
+   bson_destroy (&reply);
+
+   for (i = 0; i < INSERT_ONE_N_THREADS; i++) {
+      workers[i].pool = pool;
+      /* ids other than 3, which the responder treats as a duplicate */
+      workers[i].id = 100 + i;
+      ASSERT_CMPINT (0, ==, mcommon_thread_create (&workers[i].thread, insert_one_split_worker, &workers[i]));
+   }
+
+   for (i = 0; i < INSERT_ONE_N_THREADS; i++) {
+      mcommon_thread_join (workers[i].thread);
+      if (!workers[i].ret) {
+         ASSERT_ERROR_CONTAINS (workers[i].error, MONGOC_ERROR_QUERY, 2, "insert failed");
+         n_failed++;
+      }
+   }
+
+   ASSERT_CMPINT (ctx.n_documents, ==, INSERT_ONE_N_THREADS + 1);
+   ASSERT_CMPINT (ctx.n_failed_documents, >, 0);
+   ASSERT_CMPINT (n_failed, ==, ctx.n_failed_documents);
+
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+   bson_mutex_destroy (&ctx.mutex);
+}
+
+
+/* True if both clients of a pool with maxPoolSize=2 are idle and connected to
+ * the server. */
+static bool
+_warm_up_clients_connected (mongoc_client_pool_t *pool)
+{
+   mongoc_client_t *a = mongoc_client_pool_try_pop (pool);
+   mongoc_client_t *b = mongoc_client_pool_try_pop (pool);
+   bool connected = a && b && mongoc_set_get (a->cluster.nodes, 1) && mongoc_set_get (b->cluster.nodes, 1);
+
+   if (a) {
+      mongoc_client_pool_push (pool, a);
+   }
+   if (b) {
+      mongoc_client_pool_push (pool, b);
+   }
+
+   return connected;
+}
+
+static void
+test_client_pool_warm_up (void)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_cluster_node_t *node;
+   mongoc_uri_t *uri;
+   bson_error_t error;
+   future_t *future;
+   request_t *request;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MIN);
+   mock_server_run (server);
+
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   mongoc_uri_set_option_as_int32 (uri, MONGOC_URI_MAXPOOLSIZE, 2);
+   pool = test_framework_client_pool_new_from_uri (uri, NULL);
+
+   ASSERT_OR_PRINT (mongoc_client_pool_set_warm_up_size (pool, 2, &error), error);
+
+   /* the warm-up waits for the first pop, so the pool can still be configured */
+   ASSERT (mongoc_client_pool_set_appname (pool, "warm-up"));
+   ASSERT (mongoc_client_pool_set_error_api (pool, MONGOC_ERROR_API_VERSION_2));
+   ASSERT_CMPSIZE_T (mongoc_client_pool_get_size (pool), ==, 0);
+
+   /* both clients connect in the background, before any operation */
+   WAIT_UNTIL (_warm_up_clients_connected (pool));
+   ASSERT_CMPSIZE_T (mongoc_client_pool_get_size (pool), ==, 2);
+
+   /* an operation uses the existing connection */
+   client = mongoc_client_pool_pop (pool);
+   node = mongoc_set_get (client->cluster.nodes, 1);
+   ASSERT (node);
+   future = future_client_command_simple (client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'ping': 1}"));
+   reply_to_request_with_ok_and_destroy (request);
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+   ASSERT (mongoc_set_get (client->cluster.nodes, 1) == node);
+   mongoc_client_pool_push (pool, client);
+
+   ASSERT_OR_PRINT (mongoc_client_pool_set_warm_up_size (pool, 0, &error), error);
+
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+   mock_server_destroy (server);
+}
+
+
 void
 test_client_pool_install (TestSuite *suite)
 {
@@ -660,6 +1468,23 @@ test_client_pool_install (TestSuite *suite)
    TestSuite_AddLive (suite, "/ClientPool/destroy_without_push", test_client_pool_destroy_without_pushing);
    TestSuite_AddLive (suite, "/ClientPool/max_pool_size_exceeded", test_client_pool_max_pool_size_exceeded);
    TestSuite_Add (suite, "/ClientPool/can_override_sockettimeoutms", test_client_pool_can_override_sockettimeoutms);
+   TestSuite_Add (suite, "/ClientPool/new_shared", test_client_pool_new_shared);
+   TestSuite_Add (suite, "/ClientPool/new_shared/appname", test_client_pool_new_shared_appname);
+   TestSuite_Add (suite, "/ClientPool/new_shared/concerns", test_client_pool_new_shared_concerns);
+   TestSuite_Add (suite, "/ClientPool/new_shared/apm", test_client_pool_new_shared_apm);
+#ifdef MONGOC_ENABLE_SSL
+   TestSuite_Add (suite, "/ClientPool/new_shared/ssl_opts", test_client_pool_new_shared_ssl_opts);
+#endif
+   TestSuite_Add (suite, "/ClientPool/new_shared/server_api", test_client_pool_new_shared_server_api);
+   TestSuite_Add (
+      suite, "/ClientPool/new_shared/rejects_auto_encryption", test_client_pool_new_shared_rejects_auto_encryption);
+   TestSuite_AddMockServerTest (suite, "/ClientPool/warm_up", test_client_pool_warm_up);
+   TestSuite_AddMockServerTest (suite, "/ClientPool/parallel_scan", test_client_pool_parallel_scan);
+   TestSuite_AddMockServerTest (suite, "/ClientPool/parallel_scan/stop", test_client_pool_parallel_scan_stop);
+   TestSuite_AddMockServerTest (suite, "/ClientPool/parallel_scan/error", test_client_pool_parallel_scan_error);
+   TestSuite_Add (suite, "/ClientPool/parallel_scan/invalid_opts", test_client_pool_parallel_scan_invalid_opts);
+   TestSuite_AddMockServerTest (suite, "/ClientPool/insert_one", test_client_pool_insert_one);
+   TestSuite_AddMockServerTest (suite, "/ClientPool/insert_one/split", test_client_pool_insert_one_split);
 
    TestSuite_AddFull (
       suite,
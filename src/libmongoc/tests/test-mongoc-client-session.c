@@ -514,6 +514,94 @@ test_mock_end_sessions_pooled (void)
    _test_mock_end_sessions (true);
 }
 
+/* test that a sweep drops a timed out session from below the top of the pool,
+ * where neither a pop nor a return would reach it */
+static void
+_test_mock_session_sweep (bool pooled)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool = NULL;
+   mongoc_client_t *client;
+   mongoc_topology_t *topology;
+   uint32_t server_id;
+   bson_error_t error;
+   mongoc_client_session_t *a, *b;
+   mongoc_server_session_t *ss_a, *ss;
+   bson_t lsid_b;
+
+   server = mock_mongos_new (WIRE_VERSION_MAX);
+   mock_server_run (server);
+
+   if (pooled) {
+      pool = test_framework_client_pool_new_from_uri (mock_server_get_uri (server), NULL);
+      client = mongoc_client_pool_pop (pool);
+   } else {
+      client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   }
+
+   topology = client->topology;
+
+   /* trigger discovery */
+   server_id = mongoc_topology_select_server_id (topology, MONGOC_SS_READ, NULL, NULL, NULL, &error);
+   ASSERT_OR_PRINT (server_id, error);
+   if (pooled) {
+      /* the cached timeout follows the topology description */
+      ASSERT_CMPINT64 (topology->session_timeout_minutes, ==, 30);
+   }
+
+   a = mongoc_client_start_session (client, NULL, &error);
+   ASSERT_OR_PRINT (a, error);
+   b = mongoc_client_start_session (client, NULL, &error);
+   ASSERT_OR_PRINT (b, error);
+   bson_copy_to (mongoc_client_session_get_lsid (b), &lsid_b);
+
+   /* return A, then B on top of it */
+   ss_a = a->server_session;
+   ss_a->last_used_usec = bson_get_monotonic_time ();
+   mongoc_client_session_destroy (a);
+   b->server_session->last_used_usec = bson_get_monotonic_time ();
+   mongoc_client_session_destroy (b);
+   ASSERT_CMPSIZE_T (mongoc_server_session_pool_size (topology->session_pool), ==, 2);
+
+   /* A times out while it is pooled */
+   ss_a->last_used_usec = bson_get_monotonic_time () - 31 * 60 * (int64_t) (1000 * 1000);
+
+   /* the pool was last swept when the client was created, so this is a no-op */
+   _mongoc_topology_sweep_server_sessions (topology, false);
+   ASSERT_CMPSIZE_T (mongoc_server_session_pool_size (topology->session_pool), ==, 2);
+
+   _mongoc_topology_sweep_server_sessions (topology, true);
+   ASSERT_CMPSIZE_T (mongoc_server_session_pool_size (topology->session_pool), ==, 1);
+   ss = mongoc_server_session_pool_get_existing (topology->session_pool);
+   BSON_ASSERT (ss);
+   ASSERT_SESSIONS_MATCH (&ss->lsid, &lsid_b);
+
+   /* drop B so that no endSessions is sent */
+   mongoc_server_session_pool_drop (topology->session_pool, ss);
+
+   if (pooled) {
+      mongoc_client_pool_push (pool, client);
+      mongoc_client_pool_destroy (pool);
+   } else {
+      mongoc_client_destroy (client);
+   }
+
+   mock_server_destroy (server);
+   bson_destroy (&lsid_b);
+}
+
+static void
+test_mock_session_sweep_single (void)
+{
+   _test_mock_session_sweep (false);
+}
+
+static void
+test_mock_session_sweep_pooled (void)
+{
+   _test_mock_session_sweep (true);
+}
+
 /* Test for CDRIVER-3587 - Do not reuse server stream that becomes invalid on
  * failure to end session */
 static void
@@ -2666,6 +2754,10 @@ test_session_install (TestSuite *suite)
       suite, "/Session/end/mock/single", test_mock_end_sessions_single, test_framework_skip_if_no_crypto);
    TestSuite_AddMockServerTest (
       suite, "/Session/end/mock/pooled", test_mock_end_sessions_pooled, test_framework_skip_if_no_crypto);
+   TestSuite_AddMockServerTest (
+      suite, "/Session/sweep/mock/single", test_mock_session_sweep_single, test_framework_skip_if_no_crypto);
+   TestSuite_AddMockServerTest (
+      suite, "/Session/sweep/mock/pooled", test_mock_session_sweep_pooled, test_framework_skip_if_no_crypto);
    TestSuite_AddMockServerTest (suite,
                                 "/Session/end/mock/disconnected",
                                 test_mock_end_sessions_server_disconnect,
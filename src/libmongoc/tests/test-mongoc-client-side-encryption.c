@@ -3137,6 +3137,231 @@ test_kms_tls_options (void *unused)
    mongoc_client_destroy (keyvault_client);
 }
 
+#ifdef MONGOC_ENABLE_CLIENT_SIDE_ENCRYPTION
+/* The KMS connection tests need _mongoc_crypt_t. */
+
+/* A KMS connection the server closed while it was idle: writes succeed, but
+ * reads see EOF. */
+typedef struct {
+   mongoc_stream_t vtable;
+   int *n_writes;
+} closed_kms_stream_t;
+
+static void
+_closed_kms_stream_destroy (mongoc_stream_t *stream)
+{
+   bson_free (stream);
+}
+
+static ssize_t
+_closed_kms_stream_writev (mongoc_stream_t *stream, mongoc_iovec_t *iov, size_t iovcnt, int32_t timeout_msec)
+{
+   ssize_t total = 0;
+
+   BSON_UNUSED (timeout_msec);
+
+   (*((closed_kms_stream_t *) stream)->n_writes)++;
+   for (size_t i = 0u; i < iovcnt; i++) {
+      total += (ssize_t) iov[i].iov_len;
+   }
+
+   return total;
+}
+
+static ssize_t
+_closed_kms_stream_readv (
+   mongoc_stream_t *stream, mongoc_iovec_t *iov, size_t iovcnt, size_t min_bytes, int32_t timeout_msec)
+{
+   BSON_UNUSED (stream);
+   BSON_UNUSED (iov);
+   BSON_UNUSED (iovcnt);
+   BSON_UNUSED (min_bytes);
+   BSON_UNUSED (timeout_msec);
+
+   return 0;
+}
+
+static bool
+_closed_kms_stream_check_closed (mongoc_stream_t *stream)
+{
+   BSON_UNUSED (stream);
+
+   /* the close is only seen when reading */
+   return false;
+}
+
+static mongoc_stream_t *
+_closed_kms_stream_new (int *n_writes)
+{
+   closed_kms_stream_t *stream = (closed_kms_stream_t *) bson_malloc0 (sizeof *stream);
+
+   stream->vtable.destroy = _closed_kms_stream_destroy;
+   stream->vtable.writev = _closed_kms_stream_writev;
+   stream->vtable.readv = _closed_kms_stream_readv;
+   stream->vtable.check_closed = _closed_kms_stream_check_closed;
+   stream->n_writes = n_writes;
+
+   return (mongoc_stream_t *) stream;
+}
+
+/* Encrypt @str with the data key @keyid. */
+static void
+_kms_connections_encrypt (mongoc_client_encryption_t *client_encryption,
+                          const bson_value_t *keyid,
+                          const char *str,
+                          bson_value_t *ciphertext)
+{
+   mongoc_client_encryption_encrypt_opts_t *encrypt_opts;
+   bson_value_t value = {0};
+   bson_error_t error;
+
+   value.value_type = BSON_TYPE_UTF8;
+   value.value.v_utf8.str = (char *) str;
+   value.value.v_utf8.len = (uint32_t) strlen (str);
+
+   encrypt_opts = mongoc_client_encryption_encrypt_opts_new ();
+   mongoc_client_encryption_encrypt_opts_set_algorithm (encrypt_opts, MONGOC_AEAD_AES_256_CBC_HMAC_SHA_512_RANDOM);
+   mongoc_client_encryption_encrypt_opts_set_keyid (encrypt_opts, keyid);
+   ASSERT_OR_PRINT (mongoc_client_encryption_encrypt (client_encryption, &value, encrypt_opts, ciphertext, &error),
+                    error);
+   mongoc_client_encryption_encrypt_opts_destroy (encrypt_opts);
+}
+
+/* Create a client that decrypts replies with keys stored in the KMIP KMS. */
+static mongoc_client_t *
+_kms_connections_client_new (const bson_t *kms_providers, const bson_t *tls_opts)
+{
+   mongoc_auto_encryption_opts_t *auto_encryption_opts;
+   mongoc_client_t *client;
+   bson_error_t error;
+
+   auto_encryption_opts = mongoc_auto_encryption_opts_new ();
+   mongoc_auto_encryption_opts_set_kms_providers (auto_encryption_opts, kms_providers);
+   mongoc_auto_encryption_opts_set_tls_opts (auto_encryption_opts, tls_opts);
+   mongoc_auto_encryption_opts_set_keyvault_namespace (auto_encryption_opts, "keyvault", "datakeys");
+   mongoc_auto_encryption_opts_set_bypass_auto_encryption (auto_encryption_opts, true);
+
+   client = test_framework_new_default_client ();
+   ASSERT_OR_PRINT (mongoc_client_enable_auto_encryption (client, auto_encryption_opts, &error), error);
+   mongoc_auto_encryption_opts_destroy (auto_encryption_opts);
+
+   return client;
+}
+
+/* Find the document with @id and expect its decrypted fields to match
+ * @expected. */
+static void
+_kms_connections_find (mongoc_client_t *client, int id, const char *expected)
+{
+   mongoc_collection_t *coll;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_error_t error;
+
+   coll = mongoc_client_get_collection (client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts (coll, tmp_bson ("{'_id': %d}", id), NULL, NULL);
+   ASSERT (mongoc_cursor_next (cursor, &doc));
+   ASSERT_MATCH (doc, expected);
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (coll);
+}
+
+/* KMS requests needed at once are sent together, and their connections are
+ * reused by later requests. */
+static void
+test_kms_connections (void *unused)
+{
+   mongoc_client_t *keyvault_client;
+   mongoc_client_t *client_encrypted;
+   mongoc_client_encryption_opts_t *client_encryption_opts;
+   mongoc_client_encryption_t *client_encryption;
+   mongoc_client_encryption_datakey_opts_t *dkopts;
+   mongoc_collection_t *coll;
+   bson_t *kms_providers;
+   bson_t *tls_opts;
+   bson_value_t keyids[3];
+   bson_value_t ciphertexts[3];
+   bson_t doc = BSON_INITIALIZER;
+   bson_error_t error;
+   int n_writes = 0;
+   int i;
+
+   BSON_UNUSED (unused);
+
+   keyvault_client = test_framework_new_default_client ();
+   coll = mongoc_client_get_collection (keyvault_client, "keyvault", "datakeys");
+   (void) mongoc_collection_drop (coll, NULL);
+   mongoc_collection_destroy (coll);
+   coll = mongoc_client_get_collection (keyvault_client, "db", "coll");
+   (void) mongoc_collection_drop (coll, NULL);
+
+   kms_providers = _make_kmip_kms_provider (NULL);
+   tls_opts = _make_tls_opts ();
+
+   client_encryption_opts = mongoc_client_encryption_opts_new ();
+   mongoc_client_encryption_opts_set_kms_providers (client_encryption_opts, kms_providers);
+   mongoc_client_encryption_opts_set_tls_opts (client_encryption_opts, tls_opts);
+   mongoc_client_encryption_opts_set_keyvault_namespace (client_encryption_opts, "keyvault", "datakeys");
+   mongoc_client_encryption_opts_set_keyvault_client (client_encryption_opts, keyvault_client);
+   client_encryption = mongoc_client_encryption_new (client_encryption_opts, &error);
+   ASSERT_OR_PRINT (client_encryption, error);
+
+   /* Encrypt a value with each of three new data keys. */
+   dkopts = mongoc_client_encryption_datakey_opts_new ();
+   mongoc_client_encryption_datakey_opts_set_masterkey (dkopts, tmp_bson ("{}"));
+   for (i = 0; i < 3; i++) {
+      ASSERT_OR_PRINT (
+         mongoc_client_encryption_create_datakey (client_encryption, "kmip", dkopts, &keyids[i], &error), error);
+      _kms_connections_encrypt (client_encryption, &keyids[i], tmp_str ("value %d", i), &ciphertexts[i]);
+   }
+   mongoc_client_encryption_datakey_opts_destroy (dkopts);
+
+   /* The first document needs the first two keys, the second one the third. */
+   BSON_APPEND_INT32 (&doc, "_id", 1);
+   BSON_APPEND_VALUE (&doc, "a", &ciphertexts[0]);
+   BSON_APPEND_VALUE (&doc, "b", &ciphertexts[1]);
+   ASSERT_OR_PRINT (mongoc_collection_insert_one (coll, &doc, NULL, NULL, &error), error);
+   bson_reinit (&doc);
+   BSON_APPEND_INT32 (&doc, "_id", 2);
+   BSON_APPEND_VALUE (&doc, "c", &ciphertexts[2]);
+   ASSERT_OR_PRINT (mongoc_collection_insert_one (coll, &doc, NULL, NULL, &error), error);
+
+   /* Decrypting the first document decrypts both its keys at once, each on
+    * its own connection. Both connections are kept. */
+   client_encrypted = _kms_connections_client_new (kms_providers, tls_opts);
+   _kms_connections_find (client_encrypted, 1, "{'a': 'value 0', 'b': 'value 1'}");
+   ASSERT_CMPSIZE_T (_mongoc_crypt_idle_kms_stream_count (client_encrypted->topology->crypt), ==, 2u);
+
+   /* The third key is decrypted on one of the kept connections. */
+   _kms_connections_find (client_encrypted, 2, "{'c': 'value 2'}");
+   ASSERT_CMPSIZE_T (_mongoc_crypt_idle_kms_stream_count (client_encrypted->topology->crypt), ==, 2u);
+   mongoc_client_destroy (client_encrypted);
+
+   /* If the server closed the idle connection, the request is sent again on
+    * a new connection. */
+   client_encrypted = _kms_connections_client_new (kms_providers, tls_opts);
+   _mongoc_crypt_add_idle_kms_stream (
+      client_encrypted->topology->crypt, "kmip", "localhost:5698", _closed_kms_stream_new (&n_writes));
+   _kms_connections_find (client_encrypted, 2, "{'c': 'value 2'}");
+   ASSERT_CMPINT (n_writes, ==, 1);
+   ASSERT_CMPSIZE_T (_mongoc_crypt_idle_kms_stream_count (client_encrypted->topology->crypt), ==, 1u);
+   mongoc_client_destroy (client_encrypted);
+
+   for (i = 0; i < 3; i++) {
+      bson_value_destroy (&keyids[i]);
+      bson_value_destroy (&ciphertexts[i]);
+   }
+   bson_destroy (&doc);
+   bson_destroy (tls_opts);
+   bson_destroy (kms_providers);
+   mongoc_client_encryption_destroy (client_encryption);
+   mongoc_client_encryption_opts_destroy (client_encryption_opts);
+   mongoc_collection_destroy (coll);
+   mongoc_client_destroy (keyvault_client);
+}
+#endif /* MONGOC_ENABLE_CLIENT_SIDE_ENCRYPTION */
+
 static void
 test_kms_tls_options_extra_rejected (void *unused)
 {
@@ -6277,6 +6502,16 @@ test_client_side_encryption_install (TestSuite *suite)
                          a TLS connection. */
                       test_framework_skip_if_windows);
 
+#ifdef MONGOC_ENABLE_CLIENT_SIDE_ENCRYPTION
+   TestSuite_AddFull (suite,
+                      "/client_side_encryption/kms_connections",
+                      test_kms_connections,
+                      NULL,
+                      NULL,
+                      test_framework_skip_if_no_client_side_encryption,
+                      test_framework_skip_if_max_wire_version_less_than_8);
+#endif
+
    TestSuite_AddFull (suite,
                       "/client_side_encryption/kms_tls_options/extra_rejected",
                       test_kms_tls_options_extra_rejected,
@@ -3584,6 +3584,75 @@ test_find_limit (void)
 }
 
 
+/* a prepared find sends the same options with each filter */
+static void
+test_prepare_find (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_prepared_find_t *prepared;
+   mongoc_cursor_t *cursor;
+   future_t *future;
+   request_t *request;
+   const bson_t *doc;
+   bson_error_t error;
+   int i;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MIN);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   collection = mongoc_client_get_collection (client, "test", "test");
+
+   prepared = mongoc_collection_prepare_find (collection, tmp_bson ("{'$foo': 1}"), NULL, &error);
+   BSON_ASSERT (!prepared);
+   ASSERT_ERROR_CONTAINS (
+      error, MONGOC_ERROR_CURSOR, MONGOC_ERROR_CURSOR_INVALID_CURSOR, "Cannot use $-modifiers in opts: \"$foo\"");
+
+   prepared = mongoc_collection_prepare_find (
+      collection,
+      tmp_bson ("{'limit': {'$numberLong': '1'}, 'projection': {'_id': 0}, 'readConcern': {'level': 'local'}}"),
+      NULL,
+      &error);
+   ASSERT_OR_PRINT (prepared, error);
+
+   for (i = 0; i < 2; i++) {
+      if (i == 1) {
+         /* cursors executed after a reset belong to the new generation */
+         mongoc_client_reset (client);
+      }
+
+      cursor = mongoc_prepared_find_execute (prepared, tmp_bson ("{'a': %d}", i));
+
+      future = future_cursor_next (cursor, &doc);
+      request = mock_server_receives_msg (server,
+                                          MONGOC_MSG_NONE,
+                                          tmp_bson ("{'$db': 'test',"
+                                                    " 'find': 'test',"
+                                                    " 'filter': {'a': %d},"
+                                                    " 'limit': {'$numberLong': '1'},"
+                                                    " 'projection': {'_id': 0},"
+                                                    " 'readConcern': {'level': 'local'}}",
+                                                    i));
+
+      reply_to_request_simple (
+         request, tmp_str ("{'ok': 1, 'cursor': {'id': 0, 'ns': 'test.test', 'firstBatch': [{'a': %d}]}}", i));
+      BSON_ASSERT (future_get_bool (future));
+      ASSERT_MATCH (doc, "{'a': %d}", i);
+
+      future_destroy (future);
+      request_destroy (request);
+      mongoc_cursor_destroy (cursor);
+   }
+
+   mongoc_prepared_find_destroy (prepared);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
 /* use a mock server to test the "batch_size" parameter */
 static void
 test_find_batch_size (void)
@@ -5792,6 +5861,7 @@ test_collection_install (TestSuite *suite)
       suite, "/Collection/stats", test_stats, NULL, NULL, test_framework_skip_if_max_wire_version_more_than_17);
    TestSuite_AddMockServerTest (suite, "/Collection/stats/read_pref", test_stats_read_pref);
    TestSuite_AddMockServerTest (suite, "/Collection/find_read_concern", test_find_read_concern);
+   TestSuite_AddMockServerTest (suite, "/Collection/prepare_find", test_prepare_find);
    TestSuite_AddFull (
       suite, "/Collection/getmore_read_concern_live", test_getmore_read_concern_live, NULL, NULL, TestSuite_CheckLive);
    TestSuite_AddLive (suite, "/Collection/find_and_modify", test_find_and_modify);
@@ -2536,6 +2536,85 @@ test_open_cursor_from_reply (void)
    mongoc_client_destroy (client);
 }
 
+static void
+test_cursor_next_batch (void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   bson_t docs[10];
+   size_t n_docs;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_MIN);
+   mock_server_run (server);
+
+   client = test_framework_client_new_from_uri (mock_server_get_uri (server), NULL);
+   collection = mongoc_client_get_collection (client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts (collection, tmp_bson ("{}"), NULL, NULL);
+
+   /* the first document requires a round trip */
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'find': 'coll'}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '1234'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'firstBatch': [{'a': 0}, {'a': 1}, {'a': 2}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 0}");
+   future_destroy (future);
+   request_destroy (request);
+
+   /* the rest of the batch is returned without contacting the server */
+   ASSERT (mongoc_cursor_next_batch (cursor, docs, 10, &n_docs));
+   ASSERT_CMPSIZE_T (n_docs, ==, (size_t) 2);
+   ASSERT_MATCH (&docs[0], "{'a': 1}");
+   ASSERT_MATCH (&docs[1], "{'a': 2}");
+   ASSERT_MATCH (mongoc_cursor_current (cursor), "{'a': 2}");
+
+   /* the next batch requires a getMore */
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'$db': 'db', 'getMore': {'$numberLong': '1234'}}"));
+   reply_to_op_msg_request (request,
+                            MONGOC_MSG_NONE,
+                            tmp_bson ("{'ok': 1,"
+                                      " 'cursor': {"
+                                      "    'id': {'$numberLong': '0'},"
+                                      "    'ns': 'db.coll',"
+                                      "    'nextBatch': [{'a': 3}, {'a': 4}, {'a': 5}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 3}");
+   future_destroy (future);
+   request_destroy (request);
+
+   /* max_documents is respected */
+   ASSERT (mongoc_cursor_next_batch (cursor, docs, 1, &n_docs));
+   ASSERT_CMPSIZE_T (n_docs, ==, (size_t) 1);
+   ASSERT_MATCH (&docs[0], "{'a': 4}");
+
+   ASSERT (mongoc_cursor_next_batch (cursor, docs, 10, &n_docs));
+   ASSERT_CMPSIZE_T (n_docs, ==, (size_t) 1);
+   ASSERT_MATCH (&docs[0], "{'a': 5}");
+
+   /* the cursor is exhausted */
+   ASSERT (!mongoc_cursor_next_batch (cursor, docs, 10, &n_docs));
+   ASSERT_CMPSIZE_T (n_docs, ==, (size_t) 0);
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_destroy (client);
+   mock_server_destroy (server);
+}
+
+
 void
 test_cursor_install (TestSuite *suite)
 {
@@ -2577,6 +2656,7 @@ test_cursor_install (TestSuite *suite)
    TestSuite_AddMockServerTest (suite, "/Cursor/n_return/find_cmd/with_opts", test_n_return_find_cmd_with_opts);
    TestSuite_AddLive (suite, "/Cursor/empty_final_batch_live", test_empty_final_batch_live);
    TestSuite_AddMockServerTest (suite, "/Cursor/empty_final_batch", test_empty_final_batch);
+   TestSuite_AddMockServerTest (suite, "/Cursor/next_batch", test_cursor_next_batch);
    TestSuite_AddLive (suite, "/Cursor/error_document/query", test_error_document_query);
    TestSuite_AddLive (suite, "/Cursor/error_document/getmore", test_error_document_getmore);
    TestSuite_AddLive (suite, "/Cursor/error_document/command", test_error_document_command);
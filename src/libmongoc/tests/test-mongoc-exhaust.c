@@ -190,7 +190,8 @@ test_exhaust_cursor (bool pooled)
       // With OP_MSG, a cursor only becomes exhaust after the first getMore
       while (!cursor->in_exhaust && mongoc_cursor_next (cursor, &doc))
          ;
-      BSON_ASSERT (client->in_exhaust);
+      /* A pooled client dedicates the connection to the exhaust cursor */
+      BSON_ASSERT (client->in_exhaust == !pooled);
 
       /* destroy the cursor, make sure the connection pool was not cleared */
       generation1 = get_generation (client, cursor);
@@ -230,31 +231,42 @@ test_exhaust_cursor (bool pooled)
 
       while (!cursor->in_exhaust && (r = mongoc_cursor_next (cursor, &doc)))
          ;
-      BSON_ASSERT (client->in_exhaust);
+      BSON_ASSERT (client->in_exhaust == !pooled);
       BSON_ASSERT (r);
       BSON_ASSERT (doc);
 
       doc = NULL;
       r = mongoc_cursor_next (cursor2, &doc);
-      BSON_ASSERT (!r);
-      BSON_ASSERT (!doc);
+      if (pooled) {
+         ASSERT_OR_PRINT (r, cursor2->error);
+         BSON_ASSERT (doc);
+      } else {
+         BSON_ASSERT (!r);
+         BSON_ASSERT (!doc);
 
-      mongoc_cursor_error (cursor2, &error);
-      ASSERT_CMPUINT32 (error.domain, ==, MONGOC_ERROR_CLIENT);
-      ASSERT_CMPUINT32 (error.code, ==, MONGOC_ERROR_CLIENT_IN_EXHAUST);
+         mongoc_cursor_error (cursor2, &error);
+         ASSERT_CMPUINT32 (error.domain, ==, MONGOC_ERROR_CLIENT);
+         ASSERT_CMPUINT32 (error.code, ==, MONGOC_ERROR_CLIENT_IN_EXHAUST);
+      }
 
       mongoc_cursor_destroy (cursor2);
    }
 
-   /* make sure writes fail as well */
+   /* make sure writes fail as well, unless the client is pooled. The
+    * documents were already inserted, so a pooled client gets a duplicate key
+    * error from the server instead. */
    {
       BEGIN_IGNORE_DEPRECATIONS
       r = mongoc_collection_insert_bulk (collection, MONGOC_INSERT_NONE, (const bson_t **) bptr, 10, wr, &error);
       END_IGNORE_DEPRECATIONS
 
       BSON_ASSERT (!r);
-      ASSERT_CMPUINT32 (error.domain, ==, MONGOC_ERROR_CLIENT);
-      ASSERT_CMPUINT32 (error.code, ==, MONGOC_ERROR_CLIENT_IN_EXHAUST);
+      if (pooled) {
+         ASSERT_CMPUINT32 (error.domain, !=, MONGOC_ERROR_CLIENT);
+      } else {
+         ASSERT_CMPUINT32 (error.domain, ==, MONGOC_ERROR_CLIENT);
+         ASSERT_CMPUINT32 (error.code, ==, MONGOC_ERROR_CLIENT_IN_EXHAUST);
+      }
    }
 
    /* we're still in exhaust.
@@ -665,6 +677,240 @@ test_exhaust_server_err_2nd_batch_pooled (void)
    _mock_test_exhaust (true, SECOND_BATCH, SERVER_ERROR);
 }
 
+/* A pooled client's OP_MSG exhaust cursor streams on its own connection, so
+ * the client can run other operations before the cursor is done. */
+static void
+test_exhaust_op_msg_pooled_dedicated_connection (void)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   request_t *getmore;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_4_2);
+   mock_server_run (server);
+
+   pool = test_framework_client_pool_new_from_uri (mock_server_get_uri (server), NULL);
+   client = mongoc_client_pool_pop (pool);
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (collection, tmp_bson ("{}"), tmp_bson ("{'exhaust': true}"), NULL);
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server, MONGOC_MSG_EXHAUST_ALLOWED, tmp_bson ("{'find': 'test'}"));
+   reply_to_op_msg_request (
+      request,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'ok': 1, 'cursor': {'id': {'$numberLong': '123'}, 'ns': 'db.test', 'firstBatch': [{'a': 1}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 1}");
+   future_destroy (future);
+   request_destroy (request);
+
+   /* the server replies to the getMore with moreToCome */
+   future = future_cursor_next (cursor, &doc);
+   getmore = mock_server_receives_msg (
+      server, MONGOC_MSG_EXHAUST_ALLOWED, tmp_bson ("{'getMore': {'$numberLong': '123'}}"));
+   reply_to_op_msg_request (
+      getmore,
+      MONGOC_MSG_MORE_TO_COME,
+      tmp_bson ("{'ok': 1, 'cursor': {'id': {'$numberLong': '123'}, 'ns': 'db.test', 'nextBatch': [{'a': 2}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 2}");
+   future_destroy (future);
+
+   ASSERT (cursor->in_exhaust);
+   ASSERT (!client->in_exhaust);
+
+   /* the client is usable meanwhile, on a new connection */
+   future = future_client_command_simple (client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'ping': 1}"));
+   ASSERT_CMPINT ((int) request_get_client_port (request), !=, (int) request_get_client_port (getmore));
+   reply_to_request_with_ok_and_destroy (request);
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+
+   /* the cursor reads the last batch without sending a request */
+   future = future_cursor_next (cursor, &doc);
+   reply_to_op_msg_request (
+      getmore,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'ok': 1, 'cursor': {'id': {'$numberLong': '0'}, 'ns': 'db.test', 'nextBatch': [{'a': 3}]}}"));
+   ASSERT (future_get_bool (future));
+   ASSERT_MATCH (doc, "{'a': 3}");
+   future_destroy (future);
+   request_destroy (getmore);
+
+   ASSERT (!cursor->in_exhaust);
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+
+   mongoc_cursor_destroy (cursor);
+   mongoc_collection_destroy (collection);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+}
+
+/* Run a pooled exhaust cursor until the server streams getMore replies on its
+ * connection, and return the getMore request. */
+static request_t *
+_exhaust_op_msg_pooled_start (mock_server_t *server, mongoc_cursor_t *cursor)
+{
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   request_t *getmore;
+
+   future = future_cursor_next (cursor, &doc);
+   request = mock_server_receives_msg (server, MONGOC_MSG_EXHAUST_ALLOWED, tmp_bson ("{'find': 'test'}"));
+   reply_to_op_msg_request (
+      request,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'ok': 1, 'cursor': {'id': {'$numberLong': '123'}, 'ns': 'db.test', 'firstBatch': [{'a': 1}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (request);
+
+   future = future_cursor_next (cursor, &doc);
+   getmore = mock_server_receives_msg (
+      server, MONGOC_MSG_EXHAUST_ALLOWED, tmp_bson ("{'getMore': {'$numberLong': '123'}}"));
+   reply_to_op_msg_request (
+      getmore,
+      MONGOC_MSG_MORE_TO_COME,
+      tmp_bson ("{'ok': 1, 'cursor': {'id': {'$numberLong': '123'}, 'ns': 'db.test', 'nextBatch': [{'a': 2}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   ASSERT (cursor->in_exhaust);
+
+   return getmore;
+}
+
+/* Ping the server and return the client port the ping was sent from. */
+static uint16_t
+_exhaust_ping_port (mock_server_t *server, mongoc_client_t *client)
+{
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+   uint16_t port;
+
+   future = future_client_command_simple (client, "admin", tmp_bson ("{'ping': 1}"), NULL, NULL, &error);
+   request = mock_server_receives_msg (server, MONGOC_MSG_NONE, tmp_bson ("{'ping': 1}"));
+   port = request_get_client_port (request);
+   reply_to_request_with_ok_and_destroy (request);
+   ASSERT_OR_PRINT (future_get_bool (future), error);
+   future_destroy (future);
+
+   return port;
+}
+
+/* A connection the server sent every batch on goes back to the client. */
+static void
+test_exhaust_op_msg_pooled_reuse_connection (void)
+{
+   mock_server_t *server;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *getmore;
+   bson_error_t error;
+   uint16_t getmore_port;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_4_2);
+   mock_server_run (server);
+
+   pool = test_framework_client_pool_new_from_uri (mock_server_get_uri (server), NULL);
+   client = mongoc_client_pool_pop (pool);
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (collection, tmp_bson ("{}"), tmp_bson ("{'exhaust': true}"), NULL);
+
+   getmore = _exhaust_op_msg_pooled_start (server, cursor);
+   getmore_port = request_get_client_port (getmore);
+
+   future = future_cursor_next (cursor, &doc);
+   reply_to_op_msg_request (
+      getmore,
+      MONGOC_MSG_NONE,
+      tmp_bson ("{'ok': 1, 'cursor': {'id': {'$numberLong': '0'}, 'ns': 'db.test', 'nextBatch': [{'a': 3}]}}"));
+   ASSERT (future_get_bool (future));
+   future_destroy (future);
+   request_destroy (getmore);
+
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT_OR_PRINT (!mongoc_cursor_error (cursor, &error), error);
+   mongoc_cursor_destroy (cursor);
+
+   /* the drained connection is reused */
+   ASSERT_CMPINT ((int) _exhaust_ping_port (server, client), ==, (int) getmore_port);
+
+   /* a cursor destroyed before the server is done closes its connection */
+   cursor = mongoc_collection_find_with_opts (collection, tmp_bson ("{}"), tmp_bson ("{'exhaust': true}"), NULL);
+   getmore = _exhaust_op_msg_pooled_start (server, cursor);
+   mongoc_cursor_destroy (cursor);
+   ASSERT_CMPINT ((int) _exhaust_ping_port (server, client), !=, (int) request_get_client_port (getmore));
+   request_destroy (getmore);
+
+   mongoc_collection_destroy (collection);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mock_server_destroy (server);
+}
+
+/* An error reading the cursor's connection leaves the client's own
+ * connection open. */
+static void
+test_exhaust_op_msg_pooled_error_keeps_connection (void)
+{
+   mock_server_t *server;
+   mongoc_uri_t *uri;
+   mongoc_client_pool_t *pool;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   request_t *getmore;
+   bson_error_t error;
+   uint16_t ping_port;
+
+   server = mock_server_with_auto_hello (WIRE_VERSION_4_2);
+   mock_server_run (server);
+
+   uri = mongoc_uri_copy (mock_server_get_uri (server));
+   mongoc_uri_set_option_as_int32 (uri, MONGOC_URI_SOCKETTIMEOUTMS, 500);
+   pool = test_framework_client_pool_new_from_uri (uri, NULL);
+   client = mongoc_client_pool_pop (pool);
+   collection = mongoc_client_get_collection (client, "db", "test");
+   cursor = mongoc_collection_find_with_opts (collection, tmp_bson ("{}"), tmp_bson ("{'exhaust': true}"), NULL);
+
+   getmore = _exhaust_op_msg_pooled_start (server, cursor);
+   ping_port = _exhaust_ping_port (server, client);
+   ASSERT_CMPINT ((int) ping_port, !=, (int) request_get_client_port (getmore));
+
+   /* the server never sends the next batch */
+   ASSERT (!mongoc_cursor_next (cursor, &doc));
+   ASSERT (mongoc_cursor_error (cursor, &error));
+   ASSERT_CMPUINT32 (error.domain, ==, (uint32_t) MONGOC_ERROR_STREAM);
+
+   ASSERT_CMPINT ((int) _exhaust_ping_port (server, client), ==, (int) ping_port);
+
+   mongoc_cursor_destroy (cursor);
+   request_destroy (getmore);
+   mongoc_collection_destroy (collection);
+   mongoc_client_pool_push (pool, client);
+   mongoc_client_pool_destroy (pool);
+   mongoc_uri_destroy (uri);
+   mock_server_destroy (server);
+}
+
 #ifndef _WIN32
 #include <sys/wait.h>
 /* Test that calling mongoc_client_reset on a client that has an exhaust cursor
@@ -778,6 +1024,12 @@ test_exhaust_install (TestSuite *suite)
       suite, "/Client/exhaust_cursor/err/server/2nd_batch/single", test_exhaust_server_err_2nd_batch_single);
    TestSuite_AddMockServerTest (
       suite, "/Client/exhaust_cursor/err/server/2nd_batch/pooled", test_exhaust_server_err_2nd_batch_pooled);
+   TestSuite_AddMockServerTest (
+      suite, "/Client/exhaust_cursor/op_msg/pooled/dedicated", test_exhaust_op_msg_pooled_dedicated_connection);
+   TestSuite_AddMockServerTest (
+      suite, "/Client/exhaust_cursor/op_msg/pooled/reuse", test_exhaust_op_msg_pooled_reuse_connection);
+   TestSuite_AddMockServerTest (
+      suite, "/Client/exhaust_cursor/op_msg/pooled/error", test_exhaust_op_msg_pooled_error_keeps_connection);
 #ifndef _WIN32
    /* Skip on Windows, since "fork" is not available and this test is not
     * particularly platform dependent. */
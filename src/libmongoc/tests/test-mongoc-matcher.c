@@ -5,6 +5,7 @@
 #include <mongoc/mongoc-util-private.h>
 
 #include "TestSuite.h"
+#include "test-conveniences.h"
 
 BEGIN_IGNORE_DEPRECATIONS
 
@@ -512,6 +513,75 @@ test_mongoc_matcher_in_basic (void)
    mongoc_matcher_destroy (matcher);
 }
 
+
+static void
+test_mongoc_matcher_in_mixed (void)
+{
+   mongoc_matcher_t *matcher;
+   bson_t *spec;
+   bson_error_t error;
+
+   matcher = mongoc_matcher_new (
+      tmp_bson ("{'a.b': {'$in': ['x', 'y', 1, {'$numberLong': '2'}, 3.5, 'x']}, 'c': {'$nin': [4, 'z']}}"), &error);
+   ASSERT_OR_PRINT (matcher, error);
+
+   ASSERT (mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'x'}, 'c': 'x'}")));
+   ASSERT (mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'y'}, 'c': 5}")));
+   ASSERT (mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': {'$numberLong': '1'}}, 'c': 5}")));
+   ASSERT (mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 2}, 'c': 5}")));
+   ASSERT (mongoc_matcher_match (matcher, tmp_bson ("{'c': 'y', 'a': {'b': 3.5}}")));
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'w'}, 'c': 5}")));
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 3}, 'c': 5}")));
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': 'x', 'c': 5}")));
+   /* a missing field matches neither $in nor $nin */
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'x'}}")));
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'x'}, 'c': 'z'}")));
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'x'}, 'c': {'$numberLong': '4'}}")));
+   /* only the first "a" is matched */
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'w'}, 'a': {'b': 'x'}, 'c': 5}")));
+
+   mongoc_matcher_destroy (matcher);
+
+   /* $type checks the value at a dotted path has the type of its operand */
+   spec = BCON_NEW ("a.b", "{", "$type", BCON_INT32 (0), "}");
+   matcher = mongoc_matcher_new (spec, &error);
+   ASSERT_OR_PRINT (matcher, error);
+   ASSERT (mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 1}}")));
+   ASSERT (!mongoc_matcher_match (matcher, tmp_bson ("{'a': {'b': 'x'}}")));
+   mongoc_matcher_destroy (matcher);
+   bson_destroy (spec);
+}
+
+
+static void
+test_mongoc_matcher_match_batch (void)
+{
+   mongoc_matcher_t *matcher;
+   bson_error_t error;
+   const bson_t *documents[10];
+   uint8_t selection[2];
+
+   matcher = mongoc_matcher_new (tmp_bson ("{'a': {'$gte': 3}, 'b': {'$in': ['x', 'y']}}"), &error);
+   ASSERT_OR_PRINT (matcher, error);
+
+   for (int i = 0; i < 10; i++) {
+      documents[i] = tmp_bson ("{'a': %d, 'b': '%s'}", i, i % 2 ? "x" : "z");
+   }
+
+   /* documents 3, 5, 7, and 9 match */
+   ASSERT_CMPSIZE_T (mongoc_matcher_match_batch (matcher, documents, 10, selection), ==, (size_t) 4);
+   ASSERT_CMPUINT (selection[0], ==, 0xa8u);
+   ASSERT_CMPUINT (selection[1], ==, 0x02u);
+
+   for (size_t i = 0; i < 10; i++) {
+      ASSERT_CMPINT (!!(selection[i / 8] & (1u << (i % 8))), ==, mongoc_matcher_match (matcher, documents[i]));
+   }
+
+   ASSERT_CMPSIZE_T (mongoc_matcher_match_batch (matcher, NULL, 0, NULL), ==, (size_t) 0);
+
+   mongoc_matcher_destroy (matcher);
+}
+
 END_IGNORE_DEPRECATIONS
 
 void
@@ -527,4 +597,6 @@ test_matcher_install (TestSuite *suite)
    TestSuite_Add (suite, "/Matcher/eq/int64", test_mongoc_matcher_eq_int64);
    TestSuite_Add (suite, "/Matcher/eq/doc", test_mongoc_matcher_eq_doc);
    TestSuite_Add (suite, "/Matcher/in/basic", test_mongoc_matcher_in_basic);
+   TestSuite_Add (suite, "/Matcher/in/mixed", test_mongoc_matcher_in_mixed);
+   TestSuite_Add (suite, "/Matcher/match_batch", test_mongoc_matcher_match_batch);
 }
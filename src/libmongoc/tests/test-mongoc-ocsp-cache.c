@@ -91,6 +91,8 @@ test_mongoc_cache_insert (void)
       ASSERT_TIME_EQUAL (next_update_in, next_update_out);
       ASSERT_TIME_EQUAL (this_update_in, this_update_out);
 
+      ASN1_GENERALIZEDTIME_free (this_update_out);
+      ASN1_GENERALIZEDTIME_free (next_update_out);
       OCSP_CERTID_free (id);
    }
 
@@ -116,6 +118,7 @@ test_mongoc_cache_update (void)
 
    BSON_ASSERT (_mongoc_ocsp_cache_get_status (id, &status, &reason, &this_update_out, &next_update_out));
    BSON_ASSERT (status == V_OCSP_CERTSTATUS_GOOD);
+   ASN1_GENERALIZEDTIME_free (next_update_out);
 
    ASN1_GENERALIZEDTIME_free (next_update_in);
    next_update_in = ASN1_GENERALIZEDTIME_set (NULL, time (NULL) + 999 /* some time in the future */);
@@ -125,6 +128,7 @@ test_mongoc_cache_update (void)
 
    BSON_ASSERT (_mongoc_ocsp_cache_get_status (id, &status, &reason, &this_update_out, &next_update_out));
    BSON_ASSERT (status == V_OCSP_CERTSTATUS_REVOKED);
+   ASN1_GENERALIZEDTIME_free (next_update_out);
 
    ASN1_GENERALIZEDTIME_free (next_update_in);
    next_update_in = ASN1_GENERALIZEDTIME_set (NULL, time (NULL) - 999 /* some time in the past */);
@@ -134,6 +138,7 @@ test_mongoc_cache_update (void)
 
    BSON_ASSERT (_mongoc_ocsp_cache_get_status (id, &status, &reason, &this_update_out, &next_update_out));
    BSON_ASSERT (status == V_OCSP_CERTSTATUS_REVOKED);
+   ASN1_GENERALIZEDTIME_free (next_update_out);
 
    CLEAR_CACHE;
 
@@ -166,12 +171,44 @@ test_mongoc_cache_remove_expired_cert (void)
    CLEAR_CACHE;
 }
 
+static void
+test_mongoc_cache_insert_removes_expired (void)
+{
+   ASN1_GENERALIZEDTIME *this_update_in, *expired_in, *next_update_in;
+   int status = V_OCSP_CERTSTATUS_GOOD, reason = OCSP_REVOKED_STATUS_NOSTATUS;
+   OCSP_CERTID *expired_id = create_cert_id (1);
+   OCSP_CERTID *id = create_cert_id (2);
+
+   CLEAR_CACHE;
+
+   this_update_in = ASN1_GENERALIZEDTIME_set (NULL, time (NULL) - 999);
+   expired_in = ASN1_GENERALIZEDTIME_set (NULL, time (NULL) - 1);
+   next_update_in = ASN1_GENERALIZEDTIME_set (NULL, time (NULL) + 999);
+
+   _mongoc_ocsp_cache_set_resp (expired_id, status, reason, this_update_in, expired_in);
+   BSON_ASSERT (_mongoc_ocsp_cache_length () == 1);
+
+   /* caching a response for another certificate drops the expired one */
+   _mongoc_ocsp_cache_set_resp (id, status, reason, this_update_in, next_update_in);
+   BSON_ASSERT (_mongoc_ocsp_cache_length () == 1);
+   BSON_ASSERT (!_mongoc_ocsp_cache_get_status (expired_id, NULL, NULL, NULL, NULL));
+
+   OCSP_CERTID_free (id);
+   OCSP_CERTID_free (expired_id);
+   ASN1_GENERALIZEDTIME_free (next_update_in);
+   ASN1_GENERALIZEDTIME_free (expired_in);
+   ASN1_GENERALIZEDTIME_free (this_update_in);
+
+   CLEAR_CACHE;
+}
+
 void
 test_ocsp_cache_install (TestSuite *suite)
 {
    TestSuite_Add (suite, "/OCSPCache/insert", test_mongoc_cache_insert);
    TestSuite_Add (suite, "/OCSPCache/update", test_mongoc_cache_update);
    TestSuite_Add (suite, "/OCSPCache/remove_expired_cert", test_mongoc_cache_remove_expired_cert);
+   TestSuite_Add (suite, "/OCSPCache/insert_removes_expired", test_mongoc_cache_insert_removes_expired);
 }
 #else
 extern int no_mongoc_ocsp;
@@ -165,8 +165,11 @@ test_mongoc_utf8_to_unicode (void)
 #endif
 
 enum {
+   // the cache capacity during the cache invalidation test
+   CACHE_TEST_CAPACITY = 64,
+
    // ensure there are more users than slots in cache to test cache invalidation
-   NUM_CACHE_TEST_USERS = 10 + MONGOC_SCRAM_CACHE_SIZE,
+   NUM_CACHE_TEST_USERS = 10 + CACHE_TEST_CAPACITY,
 
    // ensure that there are several times that the cache needs to be invalidated
    NUM_CACHE_TEST_THREADS = 3 * NUM_CACHE_TEST_USERS,
@@ -246,6 +249,10 @@ test_mongoc_scram_cache_invalidation (void *ctx)
       bson_free (username);
    }
 
+#ifdef MONGOC_ENABLE_CRYPTO
+   _mongoc_scram_cache_set_capacity (CACHE_TEST_CAPACITY);
+#endif
+
    bson_thread_t threads[NUM_CACHE_TEST_THREADS];
    for (int i = 0; i < NUM_CACHE_TEST_THREADS; i++) {
       int *username_number_ptr = bson_malloc (sizeof (*username_number_ptr));
@@ -259,6 +266,10 @@ test_mongoc_scram_cache_invalidation (void *ctx)
       BSON_ASSERT (rc == 0);
    }
 
+#ifdef MONGOC_ENABLE_CRYPTO
+   _mongoc_scram_cache_set_capacity (MONGOC_SCRAM_CACHE_SIZE);
+#endif
+
    bson_free (_scram_cache_invalidation_uri_str);
    _scram_cache_invalidation_uri_str = NULL;
    mongoc_database_destroy (db);
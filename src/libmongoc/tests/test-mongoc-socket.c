@@ -454,6 +454,57 @@ test_mongoc_socket_poll_refusal (void *ctx)
 #endif
 }
 
+/* Poll more streams than fit in the preallocated arrays, and fewer. */
+static void
+_test_mongoc_socket_poll_n (size_t nstreams)
+{
+   mongoc_stream_poll_t *poller;
+   struct sockaddr_in ipv4_addr = {0};
+   size_t nhup = 0;
+   int64_t start;
+
+   ipv4_addr.sin_family = AF_INET;
+   BSON_ASSERT (inet_pton (AF_INET, "127.0.0.1", &ipv4_addr.sin_addr));
+   ipv4_addr.sin_port = htons (12345);
+
+   poller = bson_malloc0 (sizeof (*poller) * nstreams);
+   for (size_t i = 0u; i < nstreams; i++) {
+      mongoc_socket_t *sock = mongoc_socket_new (AF_INET, SOCK_STREAM, 0);
+
+      (void) mongoc_socket_connect (sock, (struct sockaddr *) &ipv4_addr, sizeof (ipv4_addr), 0);
+      poller[i].stream = mongoc_stream_socket_new (sock);
+      poller[i].events = POLLOUT | POLLERR | POLLHUP;
+   }
+
+   /* Every connection is refused, and each result is reported on its own stream. */
+   start = bson_get_monotonic_time ();
+   while (nhup < nstreams && bson_get_monotonic_time () - start < 5000 * 1000) {
+      BSON_ASSERT (mongoc_stream_poll (poller, nstreams, 10 * 1000) > 0);
+      nhup = 0;
+      for (size_t i = 0u; i < nstreams; i++) {
+         if (poller[i].revents & POLLHUP) {
+            nhup++;
+         }
+      }
+   }
+
+   ASSERT_CMPSIZE_T (nhup, ==, nstreams);
+
+   for (size_t i = 0u; i < nstreams; i++) {
+      mongoc_stream_destroy (poller[i].stream);
+   }
+   bson_free (poller);
+}
+
+static void
+test_mongoc_socket_poll_many (void *ctx)
+{
+   BSON_UNUSED (ctx);
+
+   _test_mongoc_socket_poll_n (2);
+   _test_mongoc_socket_poll_n (40);
+}
+
 void
 test_socket_install (TestSuite *suite)
 {
@@ -463,4 +514,7 @@ test_socket_install (TestSuite *suite)
    TestSuite_AddFull (suite, "/Socket/sendv", test_mongoc_socket_sendv, NULL, NULL, test_framework_skip_if_slow);
    TestSuite_AddFull (
       suite, "/Socket/connect_refusal", test_mongoc_socket_poll_refusal, NULL, NULL, test_framework_skip_if_slow);
+#ifndef _WIN32
+   TestSuite_AddFull (suite, "/Socket/poll_many", test_mongoc_socket_poll_many, NULL, NULL, test_framework_skip_if_slow);
+#endif
 }
@@ -3,6 +3,8 @@
 
 #ifdef MONGOC_ENABLE_SSL_OPENSSL
 #include <openssl/err.h>
+
+#include "mongoc/mongoc-openssl-session-cache-private.h"
 #endif
 
 #include "ssl-test.h"
@@ -180,6 +182,61 @@ test_mongoc_tls_basic (void)
 }
 
 
+#ifdef MONGOC_ENABLE_OPENSSL_SESSION_CACHE
+static void
+test_mongoc_tls_session_cache (void)
+{
+   mongoc_ssl_opt_t sopt = {0};
+   mongoc_ssl_opt_t copt = {0};
+   ssl_test_result_t sr;
+   ssl_test_result_t cr;
+   char *key, *weak_key, *other_port_key;
+   size_t length;
+
+   sopt.ca_file = CERT_CA;
+   sopt.pem_file = CERT_SERVER;
+
+   copt.ca_file = CERT_CA;
+   copt.pem_file = CERT_CLIENT;
+
+   /* ssl_test does not pass the port */
+   key = _mongoc_openssl_session_cache_key ("localhost", 0, &copt);
+   _mongoc_openssl_session_cache_remove (key);
+   length = _mongoc_openssl_session_cache_length ();
+
+   ssl_test (&copt, &sopt, "localhost", &cr, &sr);
+   ASSERT_CMPINT (cr.result, ==, SSL_TEST_SUCCESS);
+   ASSERT_CMPINT (sr.result, ==, SSL_TEST_SUCCESS);
+   ASSERT_CMPSIZE_T (_mongoc_openssl_session_cache_length (), ==, length + 1);
+
+   /* The cached session is offered, and replaced by the one issued next. */
+   ssl_test (&copt, &sopt, "localhost", &cr, &sr);
+   ASSERT_CMPINT (cr.result, ==, SSL_TEST_SUCCESS);
+   ASSERT_CMPINT (sr.result, ==, SSL_TEST_SUCCESS);
+   ASSERT_CMPSIZE_T (_mongoc_openssl_session_cache_length (), ==, length + 1);
+
+   /* Sessions verified with different options are never shared. */
+   copt.weak_cert_validation = true;
+   weak_key = _mongoc_openssl_session_cache_key ("localhost", 0, &copt);
+   BSON_ASSERT (strcmp (key, weak_key) != 0);
+
+   /* Nor are sessions with servers on other ports of the same host. */
+   other_port_key = _mongoc_openssl_session_cache_key ("localhost", 27018, &copt);
+   BSON_ASSERT (strcmp (weak_key, other_port_key) != 0);
+   bson_free (weak_key);
+   weak_key = _mongoc_openssl_session_cache_key ("localhost", 27017, &copt);
+   BSON_ASSERT (strcmp (weak_key, other_port_key) != 0);
+
+   _mongoc_openssl_session_cache_remove (key);
+   ASSERT_CMPSIZE_T (_mongoc_openssl_session_cache_length (), ==, length);
+
+   bson_free (other_port_key);
+   bson_free (weak_key);
+   bson_free (key);
+}
+#endif
+
+
 #ifdef MONGOC_ENABLE_SSL_OPENSSL
 static void
 test_mongoc_tls_weak_cert_validation (void)
@@ -437,6 +494,10 @@ test_stream_tls_install (TestSuite *suite)
    TestSuite_Add (suite, "/TLS/crl", test_mongoc_tls_crl);
 #endif
 
+#ifdef MONGOC_ENABLE_OPENSSL_SESSION_CACHE
+   TestSuite_Add (suite, "/TLS/session_cache", test_mongoc_tls_session_cache);
+#endif
+
 #if !defined(__APPLE__) && !defined(_WIN32) && defined(MONGOC_ENABLE_SSL_OPENSSL) && \
    OPENSSL_VERSION_NUMBER >= 0x10000000L
    TestSuite_Add (suite, "/TLS/trust_dir", test_mongoc_tls_trust_dir);
@@ -443,10 +443,72 @@ _test_invalid_wc_server_error (void *unused)
    mongoc_client_destroy (client);
 }
 
+static void
+test_insert_append_generates_id (void)
+{
+   mongoc_bulk_write_flags_t write_flags = MONGOC_BULK_WRITE_FLAGS_INIT;
+   mongoc_write_command_t command;
+   bson_t inserted_id = BSON_INITIALIZER;
+   bson_reader_t *reader;
+   const bson_t *doc;
+   bson_iter_t iter;
+   char oid_str[25];
+   bool eof = false;
+
+   _mongoc_write_command_init_insert (&command, tmp_bson ("{'a': 1}"), NULL, write_flags, 1);
+   _mongoc_write_command_insert_append (&command, tmp_bson ("{'_id': 2, 'b': 2}"));
+   _mongoc_write_command_insert_append (&command, tmp_bson ("{}"));
+   ASSERT_CMPINT (command.n_documents, ==, 3);
+
+   reader = bson_reader_new_from_data (command.payload.data, command.payload.len);
+
+   /* a generated _id is the first element, followed by the original ones */
+   doc = bson_reader_read (reader, NULL);
+   ASSERT (doc);
+   ASSERT (bson_validate (doc, BSON_VALIDATE_NONE, NULL));
+   ASSERT (bson_iter_init (&iter, doc) && bson_iter_next (&iter));
+   ASSERT_CMPSTR (bson_iter_key (&iter), "_id");
+   ASSERT (BSON_ITER_HOLDS_OID (&iter));
+   ASSERT (bson_iter_next (&iter));
+   ASSERT_CMPSTR (bson_iter_key (&iter), "a");
+   ASSERT (!bson_iter_next (&iter));
+
+   doc = bson_reader_read (reader, NULL);
+   ASSERT (doc);
+   ASSERT_MATCH (doc, "{'_id': 2, 'b': 2}");
+   ASSERT_CMPUINT32 (doc->len, ==, tmp_bson ("{'_id': 2, 'b': 2}")->len);
+
+   doc = bson_reader_read (reader, NULL);
+   ASSERT (doc);
+   ASSERT (bson_validate (doc, BSON_VALIDATE_NONE, NULL));
+   ASSERT_CMPUINT32 (bson_count_keys (doc), ==, 1u);
+   ASSERT (bson_iter_init_find (&iter, doc, "_id") && BSON_ITER_HOLDS_OID (&iter));
+
+   ASSERT (!bson_reader_read (reader, &eof));
+   ASSERT (eof);
+
+   bson_reader_destroy (reader);
+   _mongoc_write_command_destroy (&command);
+
+   /* the insert_one variant reports the generated _id */
+   _mongoc_write_command_init_insert_one_idl (&command, tmp_bson ("{'a': 1}"), tmp_bson ("{}"), &inserted_id, 1);
+   ASSERT (bson_iter_init_find (&iter, &inserted_id, "insertedId") && BSON_ITER_HOLDS_OID (&iter));
+   doc = bson_new_from_data (command.payload.data, command.payload.len);
+   ASSERT (doc);
+   ASSERT (bson_validate (doc, BSON_VALIDATE_NONE, NULL));
+   bson_oid_to_string (bson_iter_oid (&iter), oid_str);
+   ASSERT_MATCH (doc, "{'_id': {'$oid': '%s'}, 'a': 1}", oid_str);
+   bson_destroy ((bson_t *) doc);
+   _mongoc_write_command_destroy (&command);
+   bson_destroy (&inserted_id);
+}
+
+
 void
 test_write_command_install (TestSuite *suite)
 {
    TestSuite_AddLive (suite, "/WriteCommand/split_insert", test_split_insert);
+   TestSuite_Add (suite, "/WriteCommand/insert_append_generates_id", test_insert_append_generates_id);
    TestSuite_AddLive (suite, "/WriteCommand/bypass_not_sent", test_bypass_not_sent);
    TestSuite_AddLive (suite, "/WriteCommand/invalid_write_concern", test_invalid_write_concern);
    TestSuite_AddFull (